@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+
+namespace common {
+
+//! A fixed-size, zero-initialized heap array aligned to `Alignment` bytes (a cache line by default).
+//! Allocates once on construction, so it's suitable for DSP memory that must be sized at runtime.
+template <typename T, std::size_t Alignment = 64>
+class AlignedBuffer {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0);
+
+public:
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(std::size_t size) :
+        _data{static_cast<T*>(::operator new[](size * sizeof(T), std::align_val_t{Alignment}))},
+        _size{size} {
+        std::fill_n(_data.get(), _size, T{});
+    }
+
+    AlignedBuffer(AlignedBuffer&&) noexcept = default;
+    AlignedBuffer& operator=(AlignedBuffer&&) noexcept = default;
+
+    [[nodiscard]] T* data() noexcept { return _data.get(); }
+    [[nodiscard]] const T* data() const noexcept { return _data.get(); }
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+    [[nodiscard]] T& operator[](std::size_t i) noexcept { return _data[i]; }
+    [[nodiscard]] const T& operator[](std::size_t i) const noexcept { return _data[i]; }
+
+    [[nodiscard]] T* begin() noexcept { return data(); }
+    [[nodiscard]] T* end() noexcept { return data() + _size; }
+    [[nodiscard]] const T* begin() const noexcept { return data(); }
+    [[nodiscard]] const T* end() const noexcept { return data() + _size; }
+
+    [[nodiscard]] std::span<T> span() noexcept { return {data(), _size}; }
+    [[nodiscard]] std::span<const T> span() const noexcept { return {data(), _size}; }
+
+    void fill(const T& value) noexcept { std::fill_n(data(), _size, value); }
+
+private:
+    struct Deleter {
+        void operator()(T* p) const noexcept {
+            ::operator delete[](p, std::align_val_t{Alignment});
+        }
+    };
+
+    std::unique_ptr<T[], Deleter> _data;
+    std::size_t _size{0};
+};
+
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <common/aligned_buffer.hpp>
+#include <common/ring_buffer.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace common::audio {
+
+class BlockPool;
+
+//! Names one lifetime of a pooled block. Trivially copyable, so it can be passed through lock-free rings; turn it back
+//! into a SharedBlock with `BlockPool::tryShare`.
+struct BlockRef {
+    std::uint32_t index;
+    std::uint32_t generation;
+};
+
+//! A reference-counted handle to a block in a BlockPool. Copying a handle shares the block; the block goes back to the
+//! pool when the last handle is destroyed. Neither allocates, and any thread may release.
+class SharedBlock {
+public:
+    SharedBlock() = default;
+    ~SharedBlock() { reset(); }
+
+    SharedBlock(const SharedBlock& other) noexcept;
+    SharedBlock& operator=(const SharedBlock& other) noexcept;
+
+    SharedBlock(SharedBlock&& other) noexcept :
+        _pool{std::exchange(other._pool, nullptr)},
+        _ref{other._ref} {}
+
+    SharedBlock& operator=(SharedBlock&& other) noexcept {
+        if (this != &other) {
+            reset();
+            _pool = std::exchange(other._pool, nullptr);
+            _ref = other._ref;
+        }
+        return *this;
+    }
+
+    //! Releases this handle's reference, leaving it empty.
+    void reset() noexcept;
+
+    [[nodiscard]] explicit operator bool() const noexcept { return _pool != nullptr; }
+
+    [[nodiscard]] const FrameBlock& operator*() const noexcept;
+    [[nodiscard]] const FrameBlock* operator->() const noexcept { return &**this; }
+
+    //! For filling a freshly acquired block. Only valid before the handle is first copied: others may be reading.
+    [[nodiscard]] FrameBlock& mutableBlock() noexcept;
+
+    [[nodiscard]] BlockRef ref() const noexcept { return _ref; }
+
+private:
+    friend class BlockPool;
+    SharedBlock(BlockPool* pool, BlockRef ref) :
+        _pool{pool},
+        _ref{ref} {}
+
+    BlockPool* _pool{nullptr};
+    BlockRef _ref{};
+};
+
+//! A fixed set of cache-aligned FrameBlocks, allocated up front, handed out as SharedBlocks so one rendered block can
+//! be shared between threads (the output, UI taps, recorders) without copying it.
+//! Free blocks are kept on a lock-free (Treiber) stack. Its head is tagged with a counter that changes on every push
+//! and pop, so a stale compare-exchange can't succeed after the same block was popped and pushed back (ABA).
+//! The pool must outlive every handle to its blocks.
+class BlockPool {
+public:
+    explicit BlockPool(std::size_t numBlocks) :
+        _blocks(numBlocks),
+        _slots{std::make_unique<Slot[]>(numBlocks)},
+        _numBlocks{static_cast<std::uint32_t>(numBlocks)} {
+        for (auto i = std::uint32_t{0}; i < _numBlocks; ++i) {
+            _slots[i].next.store(i + 1 < _numBlocks ? i + 1 : Empty, std::memory_order_relaxed);
+        }
+        _head.store(pack(0, _numBlocks > 0 ? 0 : Empty), std::memory_order_release);
+    }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    //! A block nobody else holds, or an empty handle if they're all in use. Lock-free. The block's contents are
+    //! whatever its last owner left in it.
+    [[nodiscard]] SharedBlock acquire() noexcept {
+        auto head = _head.load(std::memory_order_acquire);
+        while (true) {
+            const auto index = indexOf(head);
+            if (index == Empty) {
+                return {};
+            }
+            const auto next = _slots[index].next.load(std::memory_order_relaxed);
+            if (_head.compare_exchange_weak(head, pack(tagOf(head) + 1, next), std::memory_order_acquire)) {
+                auto& slot = _slots[index];
+                const auto generation = slot.generation.load(std::memory_order_relaxed) + 1;
+                slot.generation.store(generation, std::memory_order_relaxed);
+                slot.refCount.store(1, std::memory_order_release);
+                return {this, {index, generation}};
+            }
+        }
+    }
+
+    //! Shares the block `ref` names, if it's still in that lifetime (it hasn't been released and acquired again since
+    //! `ref` was taken). Otherwise returns an empty handle.
+    [[nodiscard]] SharedBlock tryShare(BlockRef ref) noexcept {
+        if (ref.index >= _numBlocks) {
+            return {};
+        }
+        auto& slot = _slots[ref.index];
+        auto count = slot.refCount.load(std::memory_order_relaxed);
+        do {
+            if (count == 0) {
+                return {};
+            }
+        } while (!slot.refCount.compare_exchange_weak(count, count + 1, std::memory_order_acquire));
+
+        // We hold a reference now, so the block can't be recycled; but it might already have been, before we took it.
+        if (slot.generation.load(std::memory_order_relaxed) != ref.generation) {
+            release(ref.index);
+            return {};
+        }
+        return {this, ref};
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept {
+        return _numBlocks;
+    }
+
+private:
+    friend class SharedBlock;
+
+    static constexpr std::uint32_t Empty = UINT32_MAX;
+
+    struct alignas(64) Slot {
+        std::atomic<std::uint32_t> refCount{0};
+        std::atomic<std::uint32_t> generation{0};
+        std::atomic<std::uint32_t> next{Empty};
+    };
+
+    [[nodiscard]] static constexpr std::uint64_t pack(std::uint32_t tag, std::uint32_t index) noexcept {
+        return (static_cast<std::uint64_t>(tag) << 32) | index;
+    }
+    [[nodiscard]] static constexpr std::uint32_t tagOf(std::uint64_t head) noexcept {
+        return static_cast<std::uint32_t>(head >> 32);
+    }
+    [[nodiscard]] static constexpr std::uint32_t indexOf(std::uint64_t head) noexcept {
+        return static_cast<std::uint32_t>(head);
+    }
+
+    void retain(std::uint32_t index) noexcept {
+        _slots[index].refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release(std::uint32_t index) noexcept {
+        if (_slots[index].refCount.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        auto head = _head.load(std::memory_order_relaxed);
+        do {
+            _slots[index].next.store(indexOf(head), std::memory_order_relaxed);
+        } while (!_head.compare_exchange_weak(head, pack(tagOf(head) + 1, index), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    AlignedBuffer<FrameBlock> _blocks;
+    std::unique_ptr<Slot[]> _slots;
+    std::uint32_t _numBlocks;
+    std::atomic<std::uint64_t> _head{pack(0, Empty)};
+};
+
+inline SharedBlock::SharedBlock(const SharedBlock& other) noexcept :
+    _pool{other._pool},
+    _ref{other._ref} {
+    if (_pool) {
+        _pool->retain(_ref.index);
+    }
+}
+
+inline SharedBlock& SharedBlock::operator=(const SharedBlock& other) noexcept {
+    if (this != &other) {
+        if (other._pool) {
+            other._pool->retain(other._ref.index);
+        }
+        reset();
+        _pool = other._pool;
+        _ref = other._ref;
+    }
+    return *this;
+}
+
+inline void SharedBlock::reset() noexcept {
+    if (_pool) {
+        std::exchange(_pool, nullptr)->release(_ref.index);
+    }
+}
+
+inline const FrameBlock& SharedBlock::operator*() const noexcept {
+    return _pool->_blocks[_ref.index];
+}
+
+inline FrameBlock& SharedBlock::mutableBlock() noexcept {
+    return _pool->_blocks[_ref.index];
+}
+
+}
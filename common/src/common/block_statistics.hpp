@@ -0,0 +1,74 @@
+#pragma once
+
+#include <common/ring_buffer.hpp>
+#include <common/simd.hpp>
+
+#include <cmath>
+#include <limits>
+#include <span>
+
+namespace common::audio {
+
+//! A summary of one block of samples. Peak and RMS only consider finite samples.
+struct BlockStatistics {
+    float peak{0.f};
+    float rms{0.f};
+    std::size_t numNonFinite{0};
+    std::size_t numClipped{0}; //< Finite samples outside of [-1, 1].
+
+    [[nodiscard]] bool isValid() const {
+        return numNonFinite == 0 && numClipped == 0;
+    }
+};
+
+//! Computes peak, RMS, NaN/Inf and clip counts in one branch-free pass, four samples at a time.
+[[nodiscard]] inline BlockStatistics analyzeBlock(std::span<const SampleT> block) noexcept {
+    using simd::Float4;
+
+    if (block.empty()) {
+        return {};
+    }
+
+    const auto one = Float4::broadcast(1.f);
+    const auto largest = Float4::broadcast(std::numeric_limits<float>::max());
+
+    auto peak = Float4::zero();
+    auto sumOfSquares = Float4::zero();
+    auto numFinite = Float4::zero();
+    auto numClipped = Float4::zero();
+
+    const auto numVectorized = block.size() - block.size() % simd::Width;
+    for (auto i = std::size_t{0}; i < numVectorized; i += simd::Width) {
+        const auto x = Float4::load(block.data() + i);
+        const auto magnitude = abs(x);
+        const auto isFinite = magnitude <= largest; //< False for NaN and Inf.
+        const auto finiteMagnitude = magnitude & isFinite;
+
+        peak = max(peak, finiteMagnitude);
+        sumOfSquares = sumOfSquares + finiteMagnitude * finiteMagnitude;
+        numFinite = numFinite + (one & isFinite);
+        numClipped = numClipped + (one & (finiteMagnitude > one));
+    }
+
+    auto result = BlockStatistics{
+        .peak = peak.horizontalMax(),
+        .numNonFinite = numVectorized - static_cast<std::size_t>(numFinite.horizontalSum()),
+        .numClipped = static_cast<std::size_t>(numClipped.horizontalSum())};
+    auto totalSumOfSquares = static_cast<double>(sumOfSquares.horizontalSum());
+
+    for (auto i = numVectorized; i < block.size(); ++i) {
+        const auto magnitude = std::abs(block[i]);
+        if (!std::isfinite(magnitude)) {
+            result.numNonFinite++;
+            continue;
+        }
+        result.peak = std::max(result.peak, magnitude);
+        totalSumOfSquares += magnitude * magnitude;
+        result.numClipped += magnitude > 1.f;
+    }
+
+    result.rms = static_cast<float>(std::sqrt(totalSumOfSquares / static_cast<double>(block.size())));
+    return result;
+}
+
+}
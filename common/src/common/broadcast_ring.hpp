@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace common {
+
+//! Broadcasts Ts from one producer to any number of consumers, each of which reads every item at its own pace.
+//! The producer never waits: it overwrites the oldest slot whether or not everyone has read it. A consumer that falls
+//! more than N items behind skips ahead to the oldest item still in the ring, and counts what it missed.
+//! Each slot is a seqlock. Its sequence number is cleared while the producer writes, and set to the item's
+//! (1-based) index once it's complete; a consumer copies the slot, then checks the number didn't change underneath it.
+//! Consumers only read shared state, so adding one costs the producer nothing.
+template <typename T, std::size_t N = 16>
+class BroadcastRing {
+    static_assert(std::has_single_bit(N));
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    //! A consumer's position in the ring. Each reader belongs to one thread; create one per consumer.
+    class Reader {
+    public:
+        explicit Reader(const BroadcastRing& ring) :
+            _ring{&ring},
+            _next{ring._numPublished.load(std::memory_order_acquire)} {}
+
+        //! Copies the next unread item into `out`. Returns false if there isn't one yet.
+        [[nodiscard]] bool tryRead(T& out) noexcept {
+            while (true) {
+                const auto numPublished = _ring->_numPublished.load(std::memory_order_acquire);
+                if (_next == numPublished) {
+                    return false;
+                }
+                if (numPublished - _next > N) {
+                    _numDropped += numPublished - _next - N;
+                    _next = numPublished - N;
+                }
+                const auto isIntact = _ring->tryCopy(_next, out);
+                ++_next;
+                if (isIntact) {
+                    return true;
+                }
+                // The producer is overwriting this item (this reader is being lapped), so it's gone.
+                ++_numDropped;
+            }
+        }
+
+        //! Items overwritten before this reader got to them.
+        [[nodiscard]] std::uint64_t numDropped() const noexcept { return _numDropped; }
+
+    private:
+        const BroadcastRing* _ring;
+        std::uint64_t _next;
+        std::uint64_t _numDropped{0};
+    };
+
+    BroadcastRing() = default;
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+    //! Producer only. Wait-free.
+    void publish(const T& item) noexcept {
+        const auto index = _numPublished.load(std::memory_order_relaxed);
+        auto& slot = _slots[index & (N - 1)];
+
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.value, &item, sizeof(T));
+        slot.sequence.store(index + 1, std::memory_order_release);
+
+        _numPublished.store(index + 1, std::memory_order_release);
+    }
+
+    //! A reader that starts with the next item published.
+    [[nodiscard]] Reader subscribe() const {
+        return Reader{*this};
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};
+        T value;
+    };
+
+    //! Copies item `index` into `out`, if it's still intact.
+    [[nodiscard]] bool tryCopy(std::uint64_t index, T& out) const noexcept {
+        const auto& slot = _slots[index & (N - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+            return false;
+        }
+        std::memcpy(&out, &slot.value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == index + 1;
+    }
+
+    std::array<Slot, N> _slots{};
+    alignas(64) std::atomic<std::uint64_t> _numPublished{0};
+};
+
+}
@@ -1,5 +1,7 @@
 #include <common/log.hpp>
 
+#include <common/realtime_log.hpp>
+
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
@@ -68,9 +70,13 @@ void Log::init(bool enableConsoleLogging) {
     sinks.emplace_back(file_sink);
 
     s_Logger = std::make_shared<spdlog::logger>("microtone_logger", sinks.begin(), sinks.end());
+    RealtimeLog::init(s_Logger);
 }
 
 std::shared_ptr<spdlog::logger> Log::getLogger() {
+    if (RealtimeLog::isRealtimeThread()) {
+        RealtimeLog::reportSynchronousLog();
+    }
     return s_Logger;
 }
 
@@ -79,6 +85,7 @@ std::string Log::getDefaultLogfilePath() {
 }
 
 void Log::shutdown() {
+    RealtimeLog::shutdown();
     spdlog::shutdown();
     s_Logger.reset();
 }
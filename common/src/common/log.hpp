@@ -20,6 +20,8 @@ public:
     };
 
     static void init(bool enableConsoleLogging);
+
+    //! The synchronous logger. Its sinks lock and write to disk, so realtime threads should use M_RT_* instead.
     static std::shared_ptr<spdlog::logger> getLogger();
     static std::string getDefaultLogfilePath();
     static void shutdown();
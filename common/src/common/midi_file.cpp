@@ -0,0 +1,255 @@
+#include <common/midi_file.hpp>
+
+#include <common/exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+
+namespace common::midi {
+
+namespace {
+
+//! 120 beats per minute, until a file says otherwise.
+constexpr std::uint32_t DefaultTempo_us = 500'000;
+
+//! MIDI files are big-endian, regardless of the host.
+[[nodiscard]] std::uint32_t readBigEndian(const unsigned char* p, std::size_t numBytes) {
+    auto result = std::uint32_t{0};
+    for (auto i = std::size_t{0}; i < numBytes; ++i) {
+        result = (result << 8) | p[i];
+    }
+    return result;
+}
+
+[[nodiscard]] bool hasTag(const unsigned char* p, std::string_view tag) {
+    return std::memcmp(p, tag.data(), tag.size()) == 0;
+}
+
+//! Reads a chunk front to back, and throws rather than run past its end.
+class ByteReader {
+public:
+    explicit ByteReader(std::span<const unsigned char> bytes) :
+        _bytes{bytes} {}
+
+    [[nodiscard]] bool isAtEnd() const { return _position >= _bytes.size(); }
+
+    [[nodiscard]] std::uint8_t peek() const {
+        require(1);
+        return _bytes[_position];
+    }
+
+    [[nodiscard]] std::uint8_t readByte() {
+        require(1);
+        return _bytes[_position++];
+    }
+
+    [[nodiscard]] std::span<const unsigned char> read(std::size_t numBytes) {
+        require(numBytes);
+        const auto result = _bytes.subspan(_position, numBytes);
+        _position += numBytes;
+        return result;
+    }
+
+    //! Seven bits per byte, most significant first, with the top bit set on all but the last. At most four bytes.
+    [[nodiscard]] std::uint32_t readVariableLength() {
+        auto result = std::uint32_t{0};
+        for (auto i = 0; i < 4; ++i) {
+            const auto byte = readByte();
+            result = (result << 7) | (byte & 0x7f);
+            if ((byte & 0x80) == 0) {
+                return result;
+            }
+        }
+        throw MicrotoneException("MIDI file has a variable-length quantity longer than four bytes.");
+    }
+
+private:
+    void require(std::size_t numBytes) const {
+        if (numBytes > _bytes.size() - _position) {
+            throw MicrotoneException("MIDI file is truncated.");
+        }
+    }
+
+    std::span<const unsigned char> _bytes;
+    std::size_t _position{0};
+};
+
+//! An event of one track, in ticks, before the tempo map is applied.
+struct TrackEvent {
+    std::uint64_t tick;
+    std::uint32_t tempo_us; //< Non-zero for a tempo change, which is then all it is.
+    Event event;
+};
+
+//! Appends the track's events to `out`, and returns the tick it ends on.
+std::uint64_t parseTrack(std::span<const unsigned char> chunk, std::vector<TrackEvent>& out) {
+    auto reader = ByteReader{chunk};
+    auto tick = std::uint64_t{0};
+    auto runningStatus = std::uint8_t{0};
+    while (!reader.isAtEnd()) {
+        tick += reader.readVariableLength();
+
+        // Running status: channel messages may leave out their status byte if it's the same as the last one's.
+        auto status = reader.peek();
+        if (status & 0x80) {
+            static_cast<void>(reader.readByte());
+        } else if (runningStatus != 0) {
+            status = runningStatus;
+        } else {
+            throw MicrotoneException("MIDI track has data without a status byte.");
+        }
+
+        if (status == 0xff) {
+            // Meta events, and SysEx below, cancel running status.
+            runningStatus = 0;
+            const auto type = reader.readByte();
+            const auto data = reader.read(reader.readVariableLength());
+            if (type == 0x2f) {
+                return tick; // End of track.
+            }
+            if (type == 0x51 && data.size() >= 3) {
+                if (const auto tempo_us = readBigEndian(data.data(), 3); tempo_us > 0) {
+                    out.push_back({tick, tempo_us, {}});
+                }
+            }
+            continue;
+        }
+        if (status == 0xf0 || status == 0xf7) {
+            runningStatus = 0;
+            static_cast<void>(reader.read(reader.readVariableLength()));
+            continue;
+        }
+        if (status > 0xf0) {
+            throw MicrotoneException("MIDI track has a system message outside of a SysEx event.");
+        }
+
+        runningStatus = status;
+        const auto type = static_cast<std::uint8_t>(status & 0xf0);
+        const auto data1 = static_cast<std::uint8_t>(reader.readByte() & 0x7f);
+        if (type == 0xc0 || type == 0xd0) {
+            continue; // Program change and channel pressure: one data byte, and nothing the synth uses.
+        }
+        const auto data2 = static_cast<std::uint8_t>(reader.readByte() & 0x7f);
+
+        switch (type) {
+        case 0x90:
+            // A note on with no velocity is a note off, so running status can carry on through both.
+            if (data2 > 0) {
+                out.push_back({tick, 0, {0, EventType::NoteOn, data1, data2}});
+                break;
+            }
+            [[fallthrough]];
+        case 0x80:
+            out.push_back({tick, 0, {0, EventType::NoteOff, data1, 0}});
+            break;
+        case 0xb0:
+            if (data1 == 64) {
+                out.push_back({tick, 0, {0, data2 >= 64 ? EventType::SustainOn : EventType::SustainOff, 0, 0}});
+            } else {
+                out.push_back({tick, 0, {0, EventType::ControlChange, data1, data2}});
+            }
+            break;
+        default:
+            break; // Aftertouch and pitch bend.
+        }
+    }
+    // No end of track event. Tolerated: the track ends with its data.
+    return tick;
+}
+
+}
+
+MidiFile parseMidiFile(std::span<const unsigned char> bytes) {
+    if (bytes.size() < 14 || !hasTag(bytes.data(), "MThd")) {
+        throw MicrotoneException("Not a MIDI file.");
+    }
+    const auto headerSize = std::size_t{readBigEndian(bytes.data() + 4, 4)};
+    if (headerSize < 6) {
+        throw MicrotoneException("MIDI file header is too short.");
+    }
+
+    auto result = MidiFile{};
+    result.format = static_cast<int>(readBigEndian(bytes.data() + 8, 2));
+    const auto division = readBigEndian(bytes.data() + 12, 2);
+    if (result.format > 1) {
+        throw MicrotoneException("Only type 0 and type 1 MIDI files are supported.");
+    }
+    // Metrical time counts ticks per quarter note, whose length follows the tempo map. SMPTE time counts ticks per
+    // frame at a fixed frame rate (the top byte, negated; 29 means 29.97 drop frame), and ignores tempo.
+    const auto isSmpte = (division & 0x8000) != 0;
+    if (isSmpte ? (division & 0xff) == 0 || (division >> 8) == 0x80 : division == 0) {
+        throw MicrotoneException("MIDI file has no time division.");
+    }
+
+    // Chunks other than tracks are skipped, as the standard asks.
+    auto trackEvents = std::vector<TrackEvent>{};
+    auto endTick = std::uint64_t{0};
+    for (auto offset = 8 + headerSize; offset + 8 <= bytes.size();) {
+        const auto* chunk = bytes.data() + offset;
+        const auto chunkSize = std::size_t{readBigEndian(chunk + 4, 4)};
+        if (chunkSize > bytes.size() - offset - 8) {
+            throw MicrotoneException("MIDI file is truncated.");
+        }
+        if (hasTag(chunk, "MTrk")) {
+            endTick = std::max(endTick, parseTrack(bytes.subspan(offset + 8, chunkSize), trackEvents));
+            ++result.numTracks;
+        }
+        offset += 8 + chunkSize;
+    }
+
+    // Merged by tick. Stable, so events at the same tick stay in track order, and in file order within a track.
+    std::stable_sort(trackEvents.begin(), trackEvents.end(), [](const auto& a, const auto& b) { return a.tick < b.tick; });
+
+    const auto ticksPerQuarter = static_cast<double>(division);
+    const auto nsPerTickAtTempo = [&](std::uint32_t tempo_us) { return 1000. * tempo_us / ticksPerQuarter; };
+    auto nsPerTick = nsPerTickAtTempo(DefaultTempo_us);
+    if (isSmpte) {
+        const auto framesPerSecond = -static_cast<std::int8_t>(division >> 8);
+        const auto ticksPerFrame = static_cast<double>(division & 0xff);
+        nsPerTick = 1e9 / ((framesPerSecond == 29 ? 29.97 : framesPerSecond) * ticksPerFrame);
+    }
+
+    // Each tempo change starts a segment. Times are computed from the segment's start rather than accumulated tick by
+    // tick, so rounding errors don't build up over a long piece.
+    auto segmentTick = std::uint64_t{0};
+    auto segmentTime_ns = 0.;
+    const auto toTime_ns = [&](std::uint64_t tick) {
+        return segmentTime_ns + static_cast<double>(tick - segmentTick) * nsPerTick;
+    };
+
+    result.events.reserve(trackEvents.size());
+    for (const auto& trackEvent : trackEvents) {
+        if (trackEvent.tempo_us > 0) {
+            if (!isSmpte) {
+                segmentTime_ns = toTime_ns(trackEvent.tick);
+                segmentTick = trackEvent.tick;
+                nsPerTick = nsPerTickAtTempo(trackEvent.tempo_us);
+            }
+            continue;
+        }
+        auto event = trackEvent.event;
+        event.timestamp_ns = static_cast<std::uint64_t>(std::llround(toTime_ns(trackEvent.tick)));
+        result.events.push_back(event);
+    }
+    result.duration_s = toTime_ns(endTick) / 1e9;
+    return result;
+}
+
+MidiFile readMidiFile(const std::filesystem::path& path) {
+    auto stream = std::ifstream(path, std::ios::binary);
+    if (!stream) {
+        throw MicrotoneException("Failed to open MIDI file: " + path.string());
+    }
+    const auto bytes = std::vector<unsigned char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    try {
+        return parseMidiFile(bytes);
+    } catch (const MicrotoneException& e) {
+        throw MicrotoneException(path.string() + ": " + e.what());
+    }
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "common/midi_handle.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace common::midi {
+
+//! The playable contents of a Standard MIDI File, with every track merged into one timeline and the tempo map applied.
+//! Notes and the sustain pedal are kept, as is any other controller; channels are merged, since the synth plays them
+//! all the same. Program changes, pitch bend, aftertouch and SysEx are dropped.
+struct MidiFile {
+    int format{0}; //< 0 (one track) or 1 (simultaneous tracks, the first usually just the tempo map).
+    std::size_t numTracks{0};
+
+    //! In order. Timestamps are offsets from the start of the file, with the tempo map applied.
+    std::vector<Event> events;
+
+    //! Up to the end of the longest track, which may be after its last event.
+    double duration_s{0};
+};
+
+//! Parses a type 0 or type 1 file, with either metrical (ticks per quarter note) or SMPTE time.
+//! Throws a MicrotoneException if the data is malformed, truncated, or a type 2 file.
+[[nodiscard]] MidiFile parseMidiFile(std::span<const unsigned char> bytes);
+
+//! Reads and parses a .mid file. Throws a MicrotoneException if the file can't be read or parsed.
+[[nodiscard]] MidiFile readMidiFile(const std::filesystem::path& path);
+
+}
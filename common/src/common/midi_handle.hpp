@@ -1,9 +1,14 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
 
-#include <common/dirty_flagged.hpp>
-#include <common/mutex_protected.hpp>
+#include <common/broadcast_ring.hpp>
+#include <common/exception.hpp>
 
 //! This could be "device" or something to reduce conceptual overlap with lib/io, but whatever.
 namespace common::midi {
@@ -33,9 +38,51 @@ struct Note {
 
 constexpr std::size_t NumMidiNodes = 127;
 
+enum class EventType : std::uint8_t {
+    NoteOn,
+    NoteOff,
+    SustainOn,
+    SustainOff,
+    ControlChange //< Any controller other than the sustain pedal.
+};
+
+//! One midi event, as received. Compact (16 bytes), so queues of them are cheap to copy through.
+struct Event {
+    std::uint64_t timestamp_ns; //< When it was received, on the steady clock.
+    EventType type;
+    std::uint8_t note;  //< The note, or the controller number for ControlChange.
+    std::uint8_t value; //< The velocity, or the controller value for ControlChange.
+
+    [[nodiscard]] static std::uint64_t now_ns() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+    }
+
+    [[nodiscard]] static Event noteOn(int note, int velocity) {
+        return {now_ns(), EventType::NoteOn, static_cast<std::uint8_t>(note), static_cast<std::uint8_t>(velocity)};
+    }
+
+    [[nodiscard]] static Event noteOff(int note) {
+        return {now_ns(), EventType::NoteOff, static_cast<std::uint8_t>(note), 0};
+    }
+
+    [[nodiscard]] static Event sustainOn() {
+        return {now_ns(), EventType::SustainOn, 0, 0};
+    }
+
+    [[nodiscard]] static Event sustainOff() {
+        return {now_ns(), EventType::SustainOff, 0, 0};
+    }
+
+    [[nodiscard]] static Event controlChange(int controller, int value) {
+        return {now_ns(), EventType::ControlChange, static_cast<std::uint8_t>(controller), static_cast<std::uint8_t>(value)};
+    }
+};
+
 //! The state of the midi controller.
 struct Keyboard {
-    friend class KeyboardFactory;
+    friend class MidiHandle;
 
     std::array<Note, NumMidiNodes> audibleNotes;
 
@@ -53,86 +100,158 @@ struct Keyboard {
         return pressedNotes[note].isOn();
     }
 
-private:
-    std::array<Note, 128> pressedNotes;
-    bool sustainOn = false;
-};
-
-class KeyboardFactory {
-public:
-    [[nodiscard]] static Keyboard copyWithNoteOn(const Keyboard& k, int note, int velocity) {
-        auto result = k;
-        result.pressedNotes[note].triggerOn(velocity);
-        result.audibleNotes[note].triggerOn(velocity);
-        return result;
-    }
-
-    [[nodiscard]] static Keyboard copyWithNoteOff(const Keyboard& k, int note) {
-        auto result = k;
-        result.pressedNotes[note].triggerOff();
-        if (!result.sustainOn) {
-            result.audibleNotes[note].triggerOff();
-        }
-        return result;
-    }
-
-    [[nodiscard]] static Keyboard copyWithSustainOn(const Keyboard& k) {
-        auto result = k;
-        result.sustainOn = true;
-        return result;
+    [[nodiscard]] bool isSustainOn() const {
+        return sustainOn;
     }
 
-    [[nodiscard]] static Keyboard copyWithSustainOff(const Keyboard& k) {
-        auto result = k;
-        for (auto note = 0; note < result.audibleNotes.size(); ++note) {
-            if (!result.pressedNotes[note].isOn()) {
-                result.audibleNotes[note].triggerOff();
+    //! Applies one event. While the sustain pedal is down, released notes stay audible until it's lifted.
+    void apply(const Event& event) {
+        switch (event.type) {
+        case EventType::NoteOn:
+            if (event.note < NumMidiNodes) {
+                pressedNotes[event.note].triggerOn(event.value);
+                audibleNotes[event.note].triggerOn(event.value);
+            }
+            break;
+        case EventType::NoteOff:
+            if (event.note < NumMidiNodes) {
+                pressedNotes[event.note].triggerOff();
+                if (!sustainOn) {
+                    audibleNotes[event.note].triggerOff();
+                }
             }
+            break;
+        case EventType::SustainOn:
+            sustainOn = true;
+            break;
+        case EventType::SustainOff:
+            for (auto note = std::size_t{0}; note < audibleNotes.size(); ++note) {
+                if (!pressedNotes[note].isOn()) {
+                    audibleNotes[note].triggerOff();
+                }
+            }
+            sustainOn = false;
+            break;
+        case EventType::ControlChange:
+            break;
         }
-        result.sustainOn = false;
-        return result;
     }
+
+private:
+    std::array<Note, 128> pressedNotes;
+    bool sustainOn = false;
 };
 
-//! A thread safe midi state handle. NumReaders must be known to the caller.
-template <std::size_t NumReaders>
+//! The hub between midi input and everything that follows it: instruments, the UI, recorders...
+//! One writer (the midi input thread) pushes events; readers register at runtime, up to MaxReaders, into a table
+//! allocated up front. Events go through one broadcast ring that every reader follows at its own pace, so the writer's
+//! cost per event doesn't depend on how many readers there are. The current state of every note is also kept in
+//! atomics, for readers that want a snapshot (a piano roll) rather than every event.
 class MidiHandle {
 public:
+    static constexpr std::size_t MaxReaders = 16;
+
+    //! Events a reader can fall behind by before it starts missing them.
+    static constexpr std::size_t QueueSize = 256;
+
     MidiHandle() = default;
+    MidiHandle(const MidiHandle&) = delete;
+    MidiHandle& operator=(const MidiHandle&) = delete;
+
+    //! Only one thread may write.
+    void push(const Event& event) {
+        _events.publish(event);
+        updateState(event);
+    }
 
     void noteOn(int note, int velocity) {
-        _keyboard.write(KeyboardFactory::copyWithNoteOn(_keyboard.quietRead(), note, velocity));
+        push(Event::noteOn(note, velocity));
     }
 
     void noteOff(int note) {
-        _keyboard.write(KeyboardFactory::copyWithNoteOff(_keyboard.quietRead(), note));
+        push(Event::noteOff(note));
     }
 
     void sustainOn() {
-        _keyboard.write(KeyboardFactory::copyWithSustainOn(_keyboard.quietRead()));
+        push(Event::sustainOn());
     }
 
     void sustainOff() {
-        _keyboard.write(KeyboardFactory::copyWithSustainOff(_keyboard.quietRead()));
+        push(Event::sustainOff());
     }
 
-    [[nodiscard]] std::size_t registerReader() const {
-        return _keyboard.registerReader();
+    void controlChange(int controller, int value) {
+        push(Event::controlChange(controller, value));
     }
 
-    [[nodiscard]] Keyboard read(std::size_t readerId) const {
-        return _keyboard.read(readerId);
+    //! Claims a slot in the reader table. Throws if all MaxReaders are taken. The reader receives events pushed from
+    //! now on; `keyboard` gives it the state so far.
+    [[nodiscard]] std::size_t registerReader() const noexcept(false) {
+        for (auto readerId = std::size_t{0}; readerId < MaxReaders; ++readerId) {
+            auto& reader = _readers[readerId];
+            if (!reader.isRegistered.exchange(true, std::memory_order_acq_rel)) {
+                reader.cursor.emplace(_events);
+                return readerId;
+            }
+        }
+        throw MicrotoneException("Exceeded the number of allowable readers.");
     }
 
-    [[nodiscard]] bool hasChanges(std::size_t readerId) const {
-        return _keyboard.isDirty(readerId);
+    //! Frees the slot for another reader. The reader's own thread must be done with it.
+    void unregisterReader(std::size_t readerId) const {
+        _readers[readerId].isRegistered.store(false, std::memory_order_release);
+    }
+
+    //! Copies the reader's oldest unread event into `event`. Returns false if there isn't one. Only the reader's own
+    //! thread may call this.
+    [[nodiscard]] bool pop(std::size_t readerId, Event& event) const {
+        return _readers[readerId].cursor->tryRead(event);
+    }
+
+    //! Events this reader fell too far behind to receive.
+    [[nodiscard]] std::uint64_t numDroppedEvents(std::size_t readerId) const {
+        return _readers[readerId].cursor->numDropped();
+    }
+
+    //! The current state of the keyboard. Each note is read atomically, but not all of them together.
+    [[nodiscard]] Keyboard keyboard() const {
+        auto result = Keyboard{};
+        for (auto note = std::size_t{0}; note < NumMidiNodes; ++note) {
+            result.audibleNotes[note].velocity = _audibleVelocities[note].load(std::memory_order_relaxed);
+            result.pressedNotes[note].velocity = _pressedVelocities[note].load(std::memory_order_relaxed);
+        }
+        result.sustainOn = _isSustainOn.load(std::memory_order_relaxed);
+        return result;
     }
 
 private:
-    DirtyFlagged<MutexProtected<Keyboard>, NumReaders> _keyboard;
-};
+    struct Reader {
+        std::atomic<bool> isRegistered{false};
+        std::optional<BroadcastRing<Event, QueueSize>::Reader> cursor;
+    };
 
-//! For convenience while I plumb NumMidiReaders into more contexts.
-using TwoReaderMidiHandle = MidiHandle<2>;
+    //! Writer only. The writer's own keyboard is the source of truth; only notes that changed are published.
+    void updateState(const Event& event) {
+        if (event.type == EventType::SustainOff) {
+            _keyboard.apply(event);
+            for (auto note = std::size_t{0}; note < NumMidiNodes; ++note) {
+                _audibleVelocities[note].store(_keyboard.audibleNotes[note].velocity, std::memory_order_relaxed);
+            }
+        } else if (event.type != EventType::ControlChange && event.note < NumMidiNodes) {
+            _keyboard.apply(event);
+            _audibleVelocities[event.note].store(_keyboard.audibleNotes[event.note].velocity, std::memory_order_relaxed);
+            _pressedVelocities[event.note].store(_keyboard.pressedNotes[event.note].velocity, std::memory_order_relaxed);
+        }
+        _isSustainOn.store(_keyboard.isSustainOn(), std::memory_order_relaxed);
+    }
+
+    BroadcastRing<Event, QueueSize> _events;
+    mutable std::array<Reader, MaxReaders> _readers;
+
+    Keyboard _keyboard{};
+    std::array<std::atomic<int>, NumMidiNodes> _audibleVelocities{};
+    std::array<std::atomic<int>, NumMidiNodes> _pressedVelocities{};
+    std::atomic<bool> _isSustainOn{false};
+};
 
-}
\ No newline at end of file
+}
@@ -1,60 +1,107 @@
 #pragma once
 
+#include <concepts>
 #include <functional>
-#include <optional>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
 
 namespace common {
 
+//! Access to a value that holds a lock for as long as it lives, so the value can't be used after the lock is released.
+template <class T, class Lock>
+class Guarded {
+public:
+    Guarded(T& value, Lock lock) :
+        _value{&value},
+        _lock{std::move(lock)} {}
+
+    [[nodiscard]] T& operator*() const noexcept { return *_value; }
+    [[nodiscard]] T* operator->() const noexcept { return _value; }
+
+private:
+    T* _value;
+    Lock _lock;
+};
+
 //! https://awesomekling.github.io/MutexProtected-A-C++-Pattern-for-Easier-Concurrency/
-template <class T>
+//! `Mutex` may be any standard mutex type, or SpinLock. If it's shared (std::shared_mutex), reads take a shared lock,
+//! so readers only wait on writers, not on each other.
+template <class T, class Mutex = std::mutex>
 class MutexProtected {
+    static constexpr bool IsShared = requires(Mutex& m) { m.lock_shared(); };
+    using ReadLock = std::conditional_t<IsShared, std::shared_lock<Mutex>, std::unique_lock<Mutex>>;
+    using WriteLock = std::unique_lock<Mutex>;
+
 public:
     using ValueType = T;
 
     MutexProtected() = default;
-    MutexProtected(const MutexProtected& other) : _value(other._value) {}
+    MutexProtected(const MutexProtected& other) : _value(other.read()) {}
     explicit MutexProtected(const T& value) : _value(value) {}
     MutexProtected& operator=(const MutexProtected& other) {
-        _value = other._value;
+        if (this != &other) {
+            write(other.read());
+        }
         return *this;
     }
 
     MutexProtected& operator=(MutexProtected&& other) noexcept {
         if (this != &other) {
+            // Both, since `other` may still be shared. scoped_lock takes them without deadlocking, whatever the order.
+            auto lock = std::scoped_lock(_mutex, other._mutex);
             _value = std::move(other._value);
         }
         return *this;
     }
 
     //! Blocks to obtain a copy of T.
-    T read() const {
-        auto lock = std::unique_lock(_mutex);
+    [[nodiscard]] T read() const {
+        auto lock = ReadLock(_mutex);
         return _value;
     }
 
-    //! Blocks to return a const reference to T.
-    const T& readConst() const {
-        auto lock = std::unique_lock(_mutex);
-        return _value;
+    //! Blocks to invoke `fn` on a const T, and returns its result. Cheaper than `read` when only part of T is needed.
+    template <std::invocable<const T&> Fn>
+    decltype(auto) read(Fn&& fn) const {
+        auto lock = ReadLock(_mutex);
+        return std::invoke(std::forward<Fn>(fn), std::as_const(_value));
+    }
+
+    //! Blocks to return a const T that stays locked until the returned guard is destroyed.
+    [[nodiscard]] Guarded<const T, ReadLock> lockForRead() const {
+        return {_value, ReadLock(_mutex)};
+    }
+
+    //! Blocks to return a T that stays locked until the returned guard is destroyed.
+    [[nodiscard]] Guarded<T, WriteLock> lockForWrite() {
+        return {_value, WriteLock(_mutex)};
     }
 
-    //! Blocks to update T.
-    void write(const std::function<void(T&)>& mutate) {
-        auto lock = std::unique_lock(_mutex);
-        std::invoke(mutate, _value);
+    //! Blocks to update T, and returns the result of `mutate`.
+    template <std::invocable<T&> Fn>
+    decltype(auto) write(Fn&& mutate) {
+        auto lock = WriteLock(_mutex);
+        return std::invoke(std::forward<Fn>(mutate), _value);
     }
 
     //! Overload taking T.
     void write(T&& value) {
-        auto lock = std::unique_lock(_mutex);
-        _value = std::forward<T>(value);
+        auto lock = WriteLock(_mutex);
+        _value = std::move(value);
+    }
+
+    void write(const T& value) {
+        auto lock = WriteLock(_mutex);
+        _value = value;
     }
 
-    //! Tries to obtain `T` to invoke `fn`.
-    std::optional<T> readIfAvailable() const {
-        if (_mutex.try_lock()) {
-            auto unlock = std::unique_lock(_mutex, std::adopt_lock);
+    //! Tries to obtain a copy of T without blocking.
+    [[nodiscard]] std::optional<T> readIfAvailable() const {
+        auto lock = ReadLock(_mutex, std::try_to_lock);
+        if (lock.owns_lock()) {
             return _value;
         }
         return std::nullopt;
@@ -62,7 +109,11 @@ public:
 
 private:
     T _value;
-    mutable std::mutex _mutex;
+    mutable Mutex _mutex;
 };
 
-}
\ No newline at end of file
+//! For data read far more often than it's written, by several threads at once.
+template <class T>
+using SharedMutexProtected = MutexProtected<T, std::shared_mutex>;
+
+}
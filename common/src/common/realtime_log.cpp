@@ -0,0 +1,211 @@
+#include <common/realtime_log.hpp>
+
+#include <common/ring_buffer.hpp>
+
+#include <fmt/args.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace common {
+
+namespace {
+
+using RecordQueue = RingBuffer<rtlog::Record, rtlog::QueueSize>;
+
+constexpr auto flushInterval = std::chrono::milliseconds(10);
+
+thread_local bool t_isRealtime = false;
+thread_local bool t_hasClaimedQueue = false;
+thread_local RecordQueue* t_queue = nullptr;
+
+//! Queues are allocated once in `init` and never freed until `shutdown`, so producers can hold raw pointers to them.
+std::array<std::unique_ptr<RecordQueue>, rtlog::MaxRealtimeThreads> s_queues;
+std::atomic<std::size_t> s_numClaimedQueues{0};
+std::atomic<bool> s_queuesAllocated{false};
+
+std::atomic<std::size_t> s_numSynchronousLogs{0};
+std::atomic<std::size_t> s_numDroppedRecords{0};
+
+std::shared_ptr<spdlog::logger> s_logger;
+std::atomic<bool> s_running{false};
+std::thread s_flusher;
+
+//! Claims a queue for the calling realtime thread, the first time it needs one once the queues exist. A thread marked
+//! realtime before `init` gets its queue with its first record instead.
+[[nodiscard]] RecordQueue* threadQueue() noexcept {
+    if (!t_hasClaimedQueue && s_queuesAllocated.load(std::memory_order_acquire)) {
+        t_hasClaimedQueue = true;
+        // Queues aren't recycled; threads that come and go should not be marked realtime.
+        if (const auto index = s_numClaimedQueues.fetch_add(1, std::memory_order_relaxed); index < s_queues.size()) {
+            t_queue = s_queues[index].get();
+        }
+    }
+    return t_queue;
+}
+
+[[nodiscard]] spdlog::level::level_enum toSpdlogLevel(Log::LogLevel level) {
+    switch (level) {
+    case Log::LogLevel::trace:
+        return spdlog::level::trace;
+    case Log::LogLevel::debug:
+        return spdlog::level::debug;
+    case Log::LogLevel::info:
+        return spdlog::level::info;
+    case Log::LogLevel::warn:
+        return spdlog::level::warn;
+    case Log::LogLevel::error:
+        return spdlog::level::err;
+    case Log::LogLevel::critical:
+        return spdlog::level::critical;
+    default:
+        return spdlog::level::info;
+    }
+}
+
+[[nodiscard]] std::string format(const rtlog::Record& record) {
+    auto args = fmt::dynamic_format_arg_store<fmt::format_context>{};
+    for (auto i = std::size_t{0}; i < record.numArguments; ++i) {
+        const auto& arg = record.arguments[i];
+        switch (arg.type) {
+        case rtlog::Argument::Type::Int:
+            args.push_back(arg.i);
+            break;
+        case rtlog::Argument::Type::UInt:
+            args.push_back(arg.u);
+            break;
+        case rtlog::Argument::Type::Double:
+            args.push_back(arg.d);
+            break;
+        case rtlog::Argument::Type::Bool:
+            args.push_back(arg.b);
+            break;
+        case rtlog::Argument::Type::String:
+            args.push_back(arg.s);
+            break;
+        }
+    }
+
+    try {
+        return fmt::vformat(record.format, args);
+    } catch (const fmt::format_error& e) {
+        return fmt::format("Malformed realtime log record '{}': {}", record.format, e.what());
+    }
+}
+
+void write(spdlog::logger& logger, const rtlog::Record& record) {
+    logger.log(toSpdlogLevel(record.level), format(record));
+}
+
+//! Drains every queue. Only the flusher thread (or `shutdown`, after the flusher is joined) calls this.
+void drainQueues(spdlog::logger& logger) {
+    const auto writeRecord = [&logger](const rtlog::Record& record) { write(logger, record); };
+    for (const auto& queue : s_queues) {
+        if (queue) {
+            while (queue->pop(writeRecord)) {}
+        }
+    }
+}
+
+void flushLoop() {
+    auto reportedSynchronousLogs = std::size_t{0};
+    auto reportedDroppedRecords = std::size_t{0};
+
+    while (s_running.load(std::memory_order_acquire)) {
+        drainQueues(*s_logger);
+
+        if (const auto n = s_numSynchronousLogs.load(std::memory_order_relaxed); n != reportedSynchronousLogs) {
+            s_logger->warn("{} synchronous log call(s) were made from realtime threads.", n - reportedSynchronousLogs);
+            reportedSynchronousLogs = n;
+        }
+
+        if (const auto n = s_numDroppedRecords.load(std::memory_order_relaxed); n != reportedDroppedRecords) {
+            s_logger->warn("{} realtime log record(s) were dropped.", n - reportedDroppedRecords);
+            reportedDroppedRecords = n;
+        }
+
+        std::this_thread::sleep_for(flushInterval);
+    }
+}
+
+}
+
+void RealtimeLog::init(std::shared_ptr<spdlog::logger> logger) {
+    if (s_running.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    if (!s_queuesAllocated.load(std::memory_order_acquire)) {
+        for (auto& queue : s_queues) {
+            queue = std::make_unique<RecordQueue>();
+        }
+        s_queuesAllocated.store(true, std::memory_order_release);
+    }
+
+    s_logger = std::move(logger);
+    s_running.store(true, std::memory_order_release);
+    s_flusher = std::thread(&flushLoop);
+}
+
+void RealtimeLog::shutdown() {
+    if (!s_running.exchange(false)) {
+        return;
+    }
+
+    if (s_flusher.joinable()) {
+        s_flusher.join();
+    }
+
+    if (s_logger) {
+        drainQueues(*s_logger);
+        s_logger->flush();
+    }
+    s_logger.reset();
+}
+
+void RealtimeLog::markThreadRealtime() noexcept {
+    if (t_isRealtime) {
+        return;
+    }
+    t_isRealtime = true;
+    static_cast<void>(threadQueue());
+}
+
+bool RealtimeLog::isRealtimeThread() noexcept {
+    return t_isRealtime;
+}
+
+void RealtimeLog::reportSynchronousLog() noexcept {
+    s_numSynchronousLogs.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::size_t RealtimeLog::numSynchronousLogs() noexcept {
+    return s_numSynchronousLogs.load(std::memory_order_relaxed);
+}
+
+std::size_t RealtimeLog::numDroppedRecords() noexcept {
+    return s_numDroppedRecords.load(std::memory_order_relaxed);
+}
+
+void RealtimeLog::push(const rtlog::Record& record) noexcept {
+    if (!t_isRealtime) {
+        // Not a realtime thread, so blocking is acceptable. Formatting and logging can allocate and throw, though, and
+        // logging is never worth terminating over: a record that fails is dropped, and counted.
+        try {
+            if (auto logger = Log::getLogger()) {
+                write(*logger, record);
+            }
+        } catch (...) {
+            s_numDroppedRecords.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    auto* queue = threadQueue();
+    if (!queue || !queue->push(record)) {
+        s_numDroppedRecords.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <common/log.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace common {
+
+namespace rtlog {
+
+//! Records are fixed size, so the number of deferred format arguments is bounded.
+constexpr std::size_t MaxArguments = 4;
+
+//! Records per realtime thread. A thread that logs faster than the flusher drains drops records (they're counted).
+constexpr std::size_t QueueSize = 256;
+
+//! Queues are preallocated in `RealtimeLog::init`, so only this many threads can be marked realtime.
+constexpr std::size_t MaxRealtimeThreads = 8;
+
+//! A deferred format argument. Strings are stored by pointer and must outlive the flush (use literals).
+struct Argument {
+    enum class Type : std::uint8_t {
+        Int,
+        UInt,
+        Double,
+        Bool,
+        String
+    };
+
+    Type type;
+    union {
+        std::int64_t i;
+        std::uint64_t u;
+        double d;
+        bool b;
+        const char* s;
+    };
+};
+
+template <typename T>
+concept Loggable = std::is_arithmetic_v<std::remove_cvref_t<T>> || std::is_convertible_v<T, const char*>;
+
+template <Loggable T>
+[[nodiscard]] constexpr Argument makeArgument(const T& value) noexcept {
+    using U = std::remove_cvref_t<T>;
+    auto result = Argument{};
+    if constexpr (std::is_same_v<U, bool>) {
+        result.type = Argument::Type::Bool;
+        result.b = value;
+    } else if constexpr (std::is_floating_point_v<U>) {
+        result.type = Argument::Type::Double;
+        result.d = static_cast<double>(value);
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        result.type = Argument::Type::Int;
+        result.i = static_cast<std::int64_t>(value);
+    } else if constexpr (std::is_integral_v<U>) {
+        result.type = Argument::Type::UInt;
+        result.u = static_cast<std::uint64_t>(value);
+    } else {
+        result.type = Argument::Type::String;
+        result.s = value;
+    }
+    return result;
+}
+
+//! Formatting is deferred to the flusher thread, so a record only holds the format string and the raw arguments.
+struct Record {
+    Log::LogLevel level;
+    const char* format;
+    std::size_t numArguments;
+    std::array<Argument, MaxArguments> arguments;
+};
+
+}
+
+//! A logging front end for threads that must never block (the audio callback, the instrument thread).
+//! Each realtime thread owns a preallocated SPSC queue of records. A background thread drains the queues, formats the
+//! records, and forwards them to the synchronous logger returned by `Log::getLogger`.
+class RealtimeLog {
+public:
+    //! Preallocates the queues and starts the flusher. Called by `Log::init`.
+    static void init(std::shared_ptr<spdlog::logger> logger);
+
+    //! Flushes any remaining records and stops the flusher. Called by `Log::shutdown`.
+    static void shutdown();
+
+    //! Marks the calling thread as realtime and claims one of the preallocated queues (with its first record, if this
+    //! is called before `init`).
+    //! This doesn't allocate or lock, so it's safe to call at the top of every audio callback.
+    static void markThreadRealtime() noexcept;
+
+    [[nodiscard]] static bool isRealtimeThread() noexcept;
+
+    //! Invoked by the synchronous logger when it's used from a realtime thread. The flusher reports these.
+    static void reportSynchronousLog() noexcept;
+
+    //! The number of synchronous (M_INFO, M_WARN, ...) log calls made from realtime threads so far.
+    [[nodiscard]] static std::size_t numSynchronousLogs() noexcept;
+
+    //! The number of records dropped because a queue was full, no queue was available, or logging one synchronously
+    //! failed.
+    [[nodiscard]] static std::size_t numDroppedRecords() noexcept;
+
+    //! Enqueues a record. On threads that aren't marked realtime, this formats and logs synchronously.
+    template <rtlog::Loggable... Args>
+    static void log(Log::LogLevel level, const char* format, const Args&... args) noexcept {
+        static_assert(sizeof...(Args) <= rtlog::MaxArguments, "Too many arguments for a realtime log record.");
+        push(rtlog::Record{level, format, sizeof...(Args), {rtlog::makeArgument(args)...}});
+    }
+
+private:
+    static void push(const rtlog::Record& record) noexcept;
+};
+
+}
+
+#define M_RT_TRACE(...) ::common::RealtimeLog::log(::common::Log::LogLevel::trace, __VA_ARGS__)
+#define M_RT_DEBUG(...) ::common::RealtimeLog::log(::common::Log::LogLevel::debug, __VA_ARGS__)
+#define M_RT_INFO(...) ::common::RealtimeLog::log(::common::Log::LogLevel::info, __VA_ARGS__)
+#define M_RT_WARN(...) ::common::RealtimeLog::log(::common::Log::LogLevel::warn, __VA_ARGS__)
+#define M_RT_ERROR(...) ::common::RealtimeLog::log(::common::Log::LogLevel::error, __VA_ARGS__)
+#define M_RT_CRITICAL(...) ::common::RealtimeLog::log(::common::Log::LogLevel::critical, __VA_ARGS__)
@@ -3,6 +3,7 @@
 #include <array>
 #include <atomic>
 #include <functional>
+#include <utility>
 
 namespace common {
 
@@ -38,30 +39,52 @@ public:
 
     //! Returns true if an item was pushed.
     [[nodiscard]] bool push(const T& item) noexcept {
-        const auto head = _head.load(std::memory_order_relaxed);
-        const auto tail = _tail.load(std::memory_order_relaxed);
-        const auto nextHead = nextAfter(head);
-        if (nextHead != tail) {
-            _buffer[head] = item;
-            _head.store(nextHead, std::memory_order_release);
+        if (auto* slot = reserveWrite()) {
+            *slot = item;
+            commitWrite();
             return true;
         }
         return false;
     }
 
-    //! If an item is available, `fn` is invoked on it.
-    [[nodiscard]] bool pop(const std::function<void(const T&)>& fn) noexcept {
-        const auto head = _head.load(std::memory_order_acquire);
-        const auto tail = _tail.load(std::memory_order_relaxed);
-        if (head != tail) {
-            std::invoke(fn, _buffer[tail]);
-            const auto nextTail = nextAfter(tail);
-            _tail.store(nextTail, std::memory_order_release);
+    //! If an item is available, `fn` is invoked on it in place.
+    template <typename F>
+    [[nodiscard]] bool pop(F&& fn) noexcept {
+        if (const auto* item = reserveRead()) {
+            std::invoke(std::forward<F>(fn), *item);
+            commitRead();
             return true;
         }
         return false;
     }
 
+    //! Producer only. Returns the next free slot to be written in place, or nullptr if the buffer is full.
+    //! The item isn't visible to the consumer until `commitWrite`. Reserving again before committing returns the same
+    //! slot.
+    [[nodiscard]] T* reserveWrite() noexcept {
+        const auto head = _head.load(std::memory_order_relaxed);
+        const auto tail = _tail.load(std::memory_order_acquire);
+        return nextAfter(head) != tail ? &_buffer[head] : nullptr;
+    }
+
+    //! Producer only. Publishes the slot returned by the last successful `reserveWrite`.
+    void commitWrite() noexcept {
+        _head.store(nextAfter(_head.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    //! Consumer only. Returns the oldest item, to be read in place, or nullptr if the buffer is empty.
+    //! The slot isn't handed back to the producer until `commitRead`.
+    [[nodiscard]] const T* reserveRead() noexcept {
+        const auto head = _head.load(std::memory_order_acquire);
+        const auto tail = _tail.load(std::memory_order_relaxed);
+        return head != tail ? &_buffer[tail] : nullptr;
+    }
+
+    //! Consumer only. Releases the item returned by the last successful `reserveRead`.
+    void commitRead() noexcept {
+        _tail.store(nextAfter(_tail.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
 private:
     [[nodiscard]] static constexpr std::size_t nextAfter(std::size_t i) noexcept {
         return (i + 1) % N;
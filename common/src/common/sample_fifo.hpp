@@ -0,0 +1,76 @@
+#pragma once
+
+#include "aligned_buffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace common {
+
+//! A single-producer, single-consumer FIFO of samples, for handing audio between threads that work in different
+//! block sizes (for example, a pipeline that renders AudioBlockSize samples at a time, and a device callback that asks
+//! for whatever it likes).
+//! The capacity is set at runtime and rounded up to a power of two, so positions wrap with a mask. Reads and writes
+//! are bulk copies: at most two memcpys each, one on either side of the wrap.
+//! Memory is allocated on construction.
+class SampleFifo {
+public:
+    explicit SampleFifo(std::size_t minCapacity) :
+        _buffer{std::bit_ceil(std::max<std::size_t>(minCapacity, 1))},
+        _mask{_buffer.size() - 1} {}
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return _buffer.size(); }
+
+    //! Safe to call from either side; the answer is exact for the caller's own side, and conservative for the other.
+    [[nodiscard]] std::size_t availableToRead() const noexcept {
+        return static_cast<std::size_t>(_writePosition.load(std::memory_order_acquire) - _readPosition.load(std::memory_order_acquire));
+    }
+
+    [[nodiscard]] std::size_t availableToWrite() const noexcept {
+        return capacity() - availableToRead();
+    }
+
+    //! Producer only. Writes as many samples as fit, and returns how many that was.
+    std::size_t write(std::span<const float> samples) noexcept {
+        const auto writePosition = _writePosition.load(std::memory_order_relaxed);
+        const auto readPosition = _readPosition.load(std::memory_order_acquire);
+        const auto count = std::min(samples.size(), capacity() - static_cast<std::size_t>(writePosition - readPosition));
+
+        const auto start = static_cast<std::size_t>(writePosition) & _mask;
+        const auto first = std::min(count, capacity() - start);
+        std::memcpy(_buffer.data() + start, samples.data(), first * sizeof(float));
+        std::memcpy(_buffer.data(), samples.data() + first, (count - first) * sizeof(float));
+
+        _writePosition.store(writePosition + count, std::memory_order_release);
+        return count;
+    }
+
+    //! Consumer only. Reads as many samples as are available, up to `samples.size()`, and returns how many that was.
+    std::size_t read(std::span<float> samples) noexcept {
+        const auto readPosition = _readPosition.load(std::memory_order_relaxed);
+        const auto writePosition = _writePosition.load(std::memory_order_acquire);
+        const auto count = std::min(samples.size(), static_cast<std::size_t>(writePosition - readPosition));
+
+        const auto start = static_cast<std::size_t>(readPosition) & _mask;
+        const auto first = std::min(count, capacity() - start);
+        std::memcpy(samples.data(), _buffer.data() + start, first * sizeof(float));
+        std::memcpy(samples.data() + first, _buffer.data(), (count - first) * sizeof(float));
+
+        _readPosition.store(readPosition + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    AlignedBuffer<float> _buffer;
+    std::size_t _mask;
+
+    // Positions only ever increase; the difference is the fill level, so every slot is usable.
+    alignas(64) std::atomic<std::uint64_t> _readPosition{0};
+    alignas(64) std::atomic<std::uint64_t> _writePosition{0};
+};
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+
+namespace common {
+
+//! Shares a small, trivially copyable T, where readers never block writers or each other: a reader copies T, then
+//! checks that no write happened meanwhile, and tries again if one did. Writers are serialized with a mutex, and bump
+//! a sequence number (odd while writing) around each write.
+//! Suits data that's read often, by threads that mustn't wait (the audio thread), and written rarely. Since readers
+//! only ever see copies, there are no lock guards; otherwise the interface matches MutexProtected.
+template <class T>
+class SeqLockProtected {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    using ValueType = T;
+
+    SeqLockProtected() = default;
+    explicit SeqLockProtected(const T& value) : _value(value) {}
+    SeqLockProtected(const SeqLockProtected&) = delete;
+    SeqLockProtected& operator=(const SeqLockProtected&) = delete;
+
+    //! Never blocks, but retries while a write is in progress.
+    [[nodiscard]] T read() const noexcept {
+        auto result = T{};
+        while (true) {
+            const auto before = _sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            std::memcpy(&result, &_value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence.load(std::memory_order_relaxed) == before) {
+                return result;
+            }
+        }
+    }
+
+    //! Invokes `fn` on a consistent copy of T, and returns its result.
+    template <std::invocable<const T&> Fn>
+    decltype(auto) read(Fn&& fn) const {
+        const auto value = read();
+        return std::invoke(std::forward<Fn>(fn), value);
+    }
+
+    //! Blocks (on other writers only) to update T, and returns the result of `mutate`.
+    template <std::invocable<T&> Fn>
+    decltype(auto) write(Fn&& mutate) {
+        auto lock = std::unique_lock(_writerMutex);
+        auto value = read();
+        if constexpr (std::is_void_v<std::invoke_result_t<Fn, T&>>) {
+            std::invoke(std::forward<Fn>(mutate), value);
+            publish(value);
+        } else {
+            auto result = std::invoke(std::forward<Fn>(mutate), value);
+            publish(value);
+            return result;
+        }
+    }
+
+    void write(const T& value) {
+        auto lock = std::unique_lock(_writerMutex);
+        publish(value);
+    }
+
+    //! Tries once to obtain a consistent copy of T.
+    [[nodiscard]] std::optional<T> readIfAvailable() const noexcept {
+        const auto before = _sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            return std::nullopt;
+        }
+        auto result = T{};
+        std::memcpy(&result, &_value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) != before) {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+private:
+    void publish(const T& value) noexcept {
+        const auto sequence = _sequence.load(std::memory_order_relaxed);
+        _sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&_value, &value, sizeof(T));
+        _sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    T _value{};
+    alignas(64) std::atomic<std::uint64_t> _sequence{0};
+    std::mutex _writerMutex;
+};
+
+}
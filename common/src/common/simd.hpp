@@ -0,0 +1,307 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MICROTONE_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MICROTONE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+//! A minimal four-lane float abstraction over SSE2 (desktop) and NEON (Pi), with a scalar fallback.
+//! Comparisons return lane masks (all bits set or clear), which are combined with `&`, `|` and `select`.
+//! `Int4` holds four 32 bit integers: just enough for sample conversion and a per-lane xorshift RNG.
+namespace common::simd {
+
+constexpr std::size_t Width = 4;
+
+struct Float4 {
+#if defined(MICROTONE_SIMD_SSE2)
+    __m128 v;
+
+    [[nodiscard]] static Float4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+    [[nodiscard]] static Float4 broadcast(float x) { return {_mm_set1_ps(x)}; }
+    [[nodiscard]] static Float4 zero() { return {_mm_setzero_ps()}; }
+    [[nodiscard]] static Float4 fromLanes(float a, float b, float c, float d) { return {_mm_setr_ps(a, b, c, d)}; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    [[nodiscard]] float first() const { return _mm_cvtss_f32(v); }
+
+    //! Moves every lane up by one, dropping the last, and puts `x` in the first: {x, a[0], a[1], a[2]}.
+    [[nodiscard]] friend Float4 shiftIn(float x, Float4 a) {
+        return {_mm_move_ss(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(a.v), 4)), _mm_set_ss(x))};
+    }
+
+    [[nodiscard]] friend Float4 operator+(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 operator-(Float4 a, Float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 operator*(Float4 a, Float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 operator<=(Float4 a, Float4 b) { return {_mm_cmple_ps(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 operator>(Float4 a, Float4 b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 operator&(Float4 a, Float4 b) { return {_mm_and_ps(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 operator|(Float4 a, Float4 b) { return {_mm_or_ps(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 min(Float4 a, Float4 b) { return {_mm_min_ps(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 max(Float4 a, Float4 b) { return {_mm_max_ps(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 abs(Float4 a) { return {_mm_andnot_ps(_mm_set1_ps(-0.f), a.v)}; }
+
+    //! Lanes of `a` where `mask` is set, otherwise lanes of `b`.
+    [[nodiscard]] friend Float4 select(Float4 mask, Float4 a, Float4 b) {
+        return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+    }
+
+    [[nodiscard]] float horizontalSum() const {
+        auto shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        auto sums = _mm_add_ps(v, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, sums);
+        return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+    }
+
+    [[nodiscard]] float horizontalMax() const {
+        auto shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        auto maxes = _mm_max_ps(v, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, maxes);
+        return _mm_cvtss_f32(_mm_max_ss(maxes, shuffled));
+    }
+#elif defined(MICROTONE_SIMD_NEON)
+    float32x4_t v;
+
+    [[nodiscard]] static Float4 load(const float* p) { return {vld1q_f32(p)}; }
+    [[nodiscard]] static Float4 broadcast(float x) { return {vdupq_n_f32(x)}; }
+    [[nodiscard]] static Float4 zero() { return {vdupq_n_f32(0.f)}; }
+    [[nodiscard]] static Float4 fromLanes(float a, float b, float c, float d) {
+        const float lanes[4] = {a, b, c, d};
+        return {vld1q_f32(lanes)};
+    }
+    void store(float* p) const { vst1q_f32(p, v); }
+    [[nodiscard]] float first() const { return vgetq_lane_f32(v, 0); }
+
+    //! Moves every lane up by one, dropping the last, and puts `x` in the first: {x, a[0], a[1], a[2]}.
+    [[nodiscard]] friend Float4 shiftIn(float x, Float4 a) {
+        return {vextq_f32(vdupq_n_f32(x), a.v, 3)};
+    }
+
+    [[nodiscard]] friend Float4 operator+(Float4 a, Float4 b) { return {vaddq_f32(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 operator-(Float4 a, Float4 b) { return {vsubq_f32(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 operator*(Float4 a, Float4 b) { return {vmulq_f32(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 operator<=(Float4 a, Float4 b) { return {vreinterpretq_f32_u32(vcleq_f32(a.v, b.v))}; }
+    [[nodiscard]] friend Float4 operator>(Float4 a, Float4 b) { return {vreinterpretq_f32_u32(vcgtq_f32(a.v, b.v))}; }
+    [[nodiscard]] friend Float4 operator&(Float4 a, Float4 b) {
+        return {vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)))};
+    }
+    [[nodiscard]] friend Float4 operator|(Float4 a, Float4 b) {
+        return {vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)))};
+    }
+    [[nodiscard]] friend Float4 min(Float4 a, Float4 b) { return {vminq_f32(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 max(Float4 a, Float4 b) { return {vmaxq_f32(a.v, b.v)}; }
+    [[nodiscard]] friend Float4 abs(Float4 a) { return {vabsq_f32(a.v)}; }
+
+    //! Lanes of `a` where `mask` is set, otherwise lanes of `b`.
+    [[nodiscard]] friend Float4 select(Float4 mask, Float4 a, Float4 b) {
+        return {vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v)};
+    }
+
+    [[nodiscard]] float horizontalSum() const {
+#if defined(__aarch64__)
+        return vaddvq_f32(v);
+#else
+        auto pairs = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+        return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+#endif
+    }
+
+    [[nodiscard]] float horizontalMax() const {
+#if defined(__aarch64__)
+        return vmaxvq_f32(v);
+#else
+        auto pairs = vmax_f32(vget_low_f32(v), vget_high_f32(v));
+        return vget_lane_f32(vpmax_f32(pairs, pairs), 0);
+#endif
+    }
+#else
+    std::array<float, Width> v;
+
+    [[nodiscard]] static Float4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+    [[nodiscard]] static Float4 broadcast(float x) { return {{x, x, x, x}}; }
+    [[nodiscard]] static Float4 zero() { return broadcast(0.f); }
+    [[nodiscard]] static Float4 fromLanes(float a, float b, float c, float d) { return {{a, b, c, d}}; }
+    void store(float* p) const {
+        for (auto i = std::size_t{0}; i < Width; ++i) {
+            p[i] = v[i];
+        }
+    }
+    [[nodiscard]] float first() const { return v[0]; }
+
+    //! Moves every lane up by one, dropping the last, and puts `x` in the first: {x, a[0], a[1], a[2]}.
+    [[nodiscard]] friend Float4 shiftIn(float x, Float4 a) { return {{x, a.v[0], a.v[1], a.v[2]}}; }
+
+    template <typename Fn>
+    [[nodiscard]] static Float4 map(Float4 a, Float4 b, Fn&& fn) {
+        return {{fn(a.v[0], b.v[0]), fn(a.v[1], b.v[1]), fn(a.v[2], b.v[2]), fn(a.v[3], b.v[3])}};
+    }
+
+    [[nodiscard]] static float toMask(bool b) { return std::bit_cast<float>(b ? ~std::uint32_t{0} : std::uint32_t{0}); }
+    [[nodiscard]] static std::uint32_t bits(float x) { return std::bit_cast<std::uint32_t>(x); }
+
+    [[nodiscard]] friend Float4 operator+(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return x + y; }); }
+    [[nodiscard]] friend Float4 operator-(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return x - y; }); }
+    [[nodiscard]] friend Float4 operator*(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return x * y; }); }
+    [[nodiscard]] friend Float4 operator<=(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return toMask(x <= y); }); }
+    [[nodiscard]] friend Float4 operator>(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return toMask(x > y); }); }
+    [[nodiscard]] friend Float4 operator&(Float4 a, Float4 b) {
+        return map(a, b, [](float x, float y) { return std::bit_cast<float>(bits(x) & bits(y)); });
+    }
+    [[nodiscard]] friend Float4 operator|(Float4 a, Float4 b) {
+        return map(a, b, [](float x, float y) { return std::bit_cast<float>(bits(x) | bits(y)); });
+    }
+    [[nodiscard]] friend Float4 min(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return y < x ? y : x; }); }
+    [[nodiscard]] friend Float4 max(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return y > x ? y : x; }); }
+    [[nodiscard]] friend Float4 abs(Float4 a) {
+        return map(a, a, [](float x, float) { return std::bit_cast<float>(bits(x) & 0x7fffffffu); });
+    }
+
+    //! Lanes of `a` where `mask` is set, otherwise lanes of `b`.
+    [[nodiscard]] friend Float4 select(Float4 mask, Float4 a, Float4 b) {
+        return (mask & a) | map(mask, b, [](float m, float y) { return std::bit_cast<float>(~bits(m) & bits(y)); });
+    }
+
+    [[nodiscard]] float horizontalSum() const { return (v[0] + v[1]) + (v[2] + v[3]); }
+    [[nodiscard]] float horizontalMax() const {
+        const auto a = v[0] > v[1] ? v[0] : v[1];
+        const auto b = v[2] > v[3] ? v[2] : v[3];
+        return a > b ? a : b;
+    }
+#endif
+
+    [[nodiscard]] std::array<float, Width> lanes() const {
+        auto result = std::array<float, Width>{};
+        store(result.data());
+        return result;
+    }
+};
+
+struct Int4 {
+#if defined(MICROTONE_SIMD_SSE2)
+    __m128i v;
+
+    [[nodiscard]] static Int4 fromLanes(std::int32_t a, std::int32_t b, std::int32_t c, std::int32_t d) {
+        return {_mm_setr_epi32(a, b, c, d)};
+    }
+    void store(std::int32_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+    //! Saturates each lane to 16 bits.
+    void storeInt16(std::int16_t* p) const { _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(v, v)); }
+
+    [[nodiscard]] friend Int4 operator^(Int4 a, Int4 b) { return {_mm_xor_si128(a.v, b.v)}; }
+
+    template <int N>
+    [[nodiscard]] Int4 shiftLeft() const { return {_mm_slli_epi32(v, N)}; }
+
+    //! Logical: shifts in zeros, whatever the sign.
+    template <int N>
+    [[nodiscard]] Int4 shiftRight() const { return {_mm_srli_epi32(v, N)}; }
+
+    [[nodiscard]] Float4 toFloat() const { return {_mm_cvtepi32_ps(v)}; }
+
+    //! To the nearest integer. Lanes must be in range.
+    [[nodiscard]] static Int4 round(Float4 a) { return {_mm_cvtps_epi32(a.v)}; }
+#elif defined(MICROTONE_SIMD_NEON)
+    int32x4_t v;
+
+    [[nodiscard]] static Int4 fromLanes(std::int32_t a, std::int32_t b, std::int32_t c, std::int32_t d) {
+        const std::int32_t lanes[4] = {a, b, c, d};
+        return {vld1q_s32(lanes)};
+    }
+    void store(std::int32_t* p) const { vst1q_s32(p, v); }
+
+    //! Saturates each lane to 16 bits.
+    void storeInt16(std::int16_t* p) const { vst1_s16(p, vqmovn_s32(v)); }
+
+    [[nodiscard]] friend Int4 operator^(Int4 a, Int4 b) { return {veorq_s32(a.v, b.v)}; }
+
+    template <int N>
+    [[nodiscard]] Int4 shiftLeft() const { return {vshlq_n_s32(v, N)}; }
+
+    //! Logical: shifts in zeros, whatever the sign.
+    template <int N>
+    [[nodiscard]] Int4 shiftRight() const { return {vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(v), N))}; }
+
+    [[nodiscard]] Float4 toFloat() const { return {vcvtq_f32_s32(v)}; }
+
+    //! To the nearest integer. Lanes must be in range.
+    [[nodiscard]] static Int4 round(Float4 a) {
+#if defined(__aarch64__)
+        return {vcvtnq_s32_f32(a.v)};
+#else
+        // ARMv7 only truncates, so add ±0.5 first, with the sign of each lane.
+        const auto sign = vandq_u32(vreinterpretq_u32_f32(a.v), vdupq_n_u32(0x80000000u));
+        const auto half = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(vdupq_n_f32(0.5f)), sign));
+        return {vcvtq_s32_f32(vaddq_f32(a.v, half))};
+#endif
+    }
+#else
+    std::array<std::int32_t, Width> v;
+
+    [[nodiscard]] static Int4 fromLanes(std::int32_t a, std::int32_t b, std::int32_t c, std::int32_t d) {
+        return {{a, b, c, d}};
+    }
+    void store(std::int32_t* p) const {
+        for (auto i = std::size_t{0}; i < Width; ++i) {
+            p[i] = v[i];
+        }
+    }
+
+    //! Saturates each lane to 16 bits.
+    void storeInt16(std::int16_t* p) const {
+        for (auto i = std::size_t{0}; i < Width; ++i) {
+            p[i] = static_cast<std::int16_t>(v[i] < -32768 ? -32768 : v[i] > 32767 ? 32767 : v[i]);
+        }
+    }
+
+    [[nodiscard]] friend Int4 operator^(Int4 a, Int4 b) {
+        return {{a.v[0] ^ b.v[0], a.v[1] ^ b.v[1], a.v[2] ^ b.v[2], a.v[3] ^ b.v[3]}};
+    }
+
+    template <int N>
+    [[nodiscard]] Int4 shiftLeft() const {
+        auto result = Int4{};
+        for (auto i = std::size_t{0}; i < Width; ++i) {
+            result.v[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(v[i]) << N);
+        }
+        return result;
+    }
+
+    //! Logical: shifts in zeros, whatever the sign.
+    template <int N>
+    [[nodiscard]] Int4 shiftRight() const {
+        auto result = Int4{};
+        for (auto i = std::size_t{0}; i < Width; ++i) {
+            result.v[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(v[i]) >> N);
+        }
+        return result;
+    }
+
+    [[nodiscard]] Float4 toFloat() const {
+        return Float4::fromLanes(static_cast<float>(v[0]), static_cast<float>(v[1]), static_cast<float>(v[2]), static_cast<float>(v[3]));
+    }
+
+    //! To the nearest integer. Lanes must be in range.
+    [[nodiscard]] static Int4 round(Float4 a) {
+        const auto lanes = a.lanes();
+        return {{static_cast<std::int32_t>(std::lrint(lanes[0])),
+                 static_cast<std::int32_t>(std::lrint(lanes[1])),
+                 static_cast<std::int32_t>(std::lrint(lanes[2])),
+                 static_cast<std::int32_t>(std::lrint(lanes[3]))}};
+    }
+#endif
+
+    [[nodiscard]] std::array<std::int32_t, Width> lanes() const {
+        auto result = std::array<std::int32_t, Width>{};
+        store(result.data());
+        return result;
+    }
+};
+
+}
@@ -1,19 +1,82 @@
 #pragma once
 
-#include <deque>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
 
 namespace common {
 
+//! The last `capacity` items pushed, with a cursor for stepping back and forth through them.
+//! Items live in a ring allocated on construction: pushing overwrites the oldest item in place, and windows are
+//! non-owning views into the ring, so neither allocates nor copies.
 template <typename T>
 struct SlidingWindow {
-    explicit SlidingWindow(std::size_t maxSize) : _maxSize(maxSize) {}
+    //! A run of consecutive items, oldest first. Only valid until the next push, so if another thread pushes, hold
+    //! its lock for as long as the view is in use.
+    class View {
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            Iterator() = default;
+            Iterator(const SlidingWindow* window, std::size_t index) :
+                _window{window},
+                _index{index} {}
+
+            [[nodiscard]] reference operator*() const { return _window->at(_index); }
+            [[nodiscard]] pointer operator->() const { return &_window->at(_index); }
+
+            Iterator& operator++() {
+                ++_index;
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                auto result = *this;
+                ++_index;
+                return result;
+            }
+
+            [[nodiscard]] bool operator==(const Iterator& other) const { return _index == other._index; }
+
+        private:
+            const SlidingWindow* _window{nullptr};
+            std::size_t _index{0};
+        };
+
+        View(const SlidingWindow& window, std::size_t first, std::size_t count) :
+            _window{&window},
+            _first{first},
+            _count{count} {}
+
+        [[nodiscard]] std::size_t size() const { return _count; }
+        [[nodiscard]] bool empty() const { return _count == 0; }
+        [[nodiscard]] const T& operator[](std::size_t i) const { return _window->at(_first + i); }
+
+        [[nodiscard]] Iterator begin() const { return {_window, _first}; }
+        [[nodiscard]] Iterator end() const { return {_window, _first + _count}; }
+
+    private:
+        const SlidingWindow* _window;
+        std::size_t _first;
+        std::size_t _count;
+    };
+
+    explicit SlidingWindow(std::size_t capacity) :
+        _items(std::max<std::size_t>(capacity, 1)) {}
 
     [[nodiscard]] bool hasNext() const {
-        return _currentIndex < _items.size();
+        return _currentIndex < _size;
     }
 
     [[nodiscard]] std::size_t numNext() const {
-        return _items.size() - _currentIndex;
+        return _size - _currentIndex;
     }
 
     [[nodiscard]] bool hasPrevious() const {
@@ -33,6 +96,10 @@ struct SlidingWindow {
     }
 
     [[nodiscard]] std::size_t size() const {
+        return _size;
+    }
+
+    [[nodiscard]] std::size_t capacity() const {
         return _items.size();
     }
 
@@ -44,34 +111,42 @@ struct SlidingWindow {
         _currentIndex = index;
     }
 
+    //! Once full, overwrites the oldest item. The cursor stays on the same item, unless that was the oldest.
     void push(const T& item) {
-        _items.push_back(item);
-        if (_items.size() > _maxSize) {
-            _items.pop_front();
+        if (_size < capacity()) {
+            _items[(_oldest + _size) % capacity()] = item;
+            ++_size;
+            return;
+        }
+        _items[_oldest] = item;
+        _oldest = (_oldest + 1) % capacity();
+        if (_currentIndex > 0) {
             _currentIndex--;
         }
     }
 
-    [[nodiscard]] std::vector<T> currentWindow(std::size_t windowSize) const {
-        if (_items.empty()) {
-            return {};
+    //! Item `i`, counting from the oldest.
+    [[nodiscard]] const T& at(std::size_t i) const {
+        return _items[(_oldest + i) % capacity()];
+    }
+
+    //! Up to `windowSize` items, starting at the cursor.
+    [[nodiscard]] View currentWindow(std::size_t windowSize) const {
+        if (_size == 0) {
+            return {*this, 0, 0};
         }
 
-        const auto bufferSize = _items.size();
-        auto front = std::min(_currentIndex, bufferSize - 1);
-        auto back  = std::min(front + windowSize, bufferSize);
-        return {
-            std::next(_items.begin(), front),
-            std::next(_items.begin(), back)
-        };
+        const auto front = std::min(_currentIndex, _size - 1);
+        const auto back = std::min(front + windowSize, _size);
+        return {*this, front, back - front};
     }
 
 private:
-    std::deque<T> _items;
+    std::vector<T> _items;
+    std::size_t _oldest = 0;
+    std::size_t _size = 0;
 
     std::size_t _currentIndex = 0;
-    std::size_t _maxSize;
 };
 
-
-}
\ No newline at end of file
+}
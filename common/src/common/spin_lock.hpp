@@ -0,0 +1,51 @@
+#pragma once
+
+#include "mutex_protected.hpp"
+
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
+namespace common {
+
+//! A test-and-test-and-set lock that never sleeps. Only for critical sections a few dozen instructions long, such
+//! as copying a small struct: waiting threads burn their core, and nothing stops the holder from being preempted.
+//! Meets the standard Lockable requirements, so it works with std::unique_lock and MutexProtected.
+class SpinLock {
+public:
+    void lock() noexcept {
+        while (_isLocked.exchange(true, std::memory_order_acquire)) {
+            // Spin on a plain load, so waiting cores share the cache line instead of fighting over it.
+            while (_isLocked.load(std::memory_order_relaxed)) {
+                pause();
+            }
+        }
+    }
+
+    [[nodiscard]] bool try_lock() noexcept {
+        return !_isLocked.load(std::memory_order_relaxed) && !_isLocked.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() noexcept {
+        _isLocked.store(false, std::memory_order_release);
+    }
+
+private:
+    static void pause() noexcept {
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
+    alignas(64) std::atomic<bool> _isLocked{false};
+};
+
+//! For small values behind short critical sections, where a mutex's syscalls would cost more than the work.
+template <class T>
+using SpinProtected = MutexProtected<T, SpinLock>;
+
+}
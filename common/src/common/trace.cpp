@@ -0,0 +1,204 @@
+#include <common/trace.hpp>
+
+#include <common/log.hpp>
+#include <common/ring_buffer.hpp>
+
+#include <fmt/format.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <thread>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+namespace common {
+
+namespace {
+
+using ZoneQueue = RingBuffer<trace::Zone, trace::QueueSize>;
+
+struct ThreadBuffer {
+    ZoneQueue zones;
+    std::atomic<const char*> name{nullptr};
+};
+
+thread_local bool t_hasClaimedBuffer = false;
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+//! Buffers are allocated once in `init` and never freed until exit, so producers can hold raw pointers to them.
+std::array<std::unique_ptr<ThreadBuffer>, trace::MaxThreads> s_buffers;
+std::atomic<std::size_t> s_numClaimedBuffers{0};
+std::atomic<bool> s_buffersAllocated{false};
+std::atomic<std::size_t> s_numDroppedZones{0};
+
+std::FILE* s_file = nullptr;
+std::uint64_t s_start_ns = 0;
+std::size_t s_numWrittenZones = 0;
+std::atomic<bool> s_running{false};
+std::thread s_writer;
+
+//! Claims a buffer for the calling thread, the first time it records.
+[[nodiscard]] ThreadBuffer* threadBuffer() noexcept {
+    if (!t_hasClaimedBuffer && s_buffersAllocated.load(std::memory_order_acquire)) {
+        t_hasClaimedBuffer = true;
+        // Buffers aren't recycled; threads that come and go shouldn't record.
+        if (const auto index = s_numClaimedBuffers.fetch_add(1, std::memory_order_relaxed); index < s_buffers.size()) {
+            t_buffer = s_buffers[index].get();
+        }
+    }
+    return t_buffer;
+}
+
+[[nodiscard]] double toMicroseconds(std::uint64_t ns) {
+    return static_cast<double>(ns) / 1000;
+}
+
+void writeEvent(std::string_view event) {
+    fmt::print(s_file, "{}{}", s_numWrittenZones++ == 0 ? "\n" : ",\n", event);
+}
+
+//! Drains every buffer. Only the writer thread (or `shutdown`, after the writer is joined) calls this.
+void drainBuffers() {
+    for (auto tid = std::size_t{0}; tid < s_buffers.size(); ++tid) {
+        const auto writeZone = [tid](const trace::Zone& zone) {
+            const auto begin_ns = zone.begin_ns > s_start_ns ? zone.begin_ns - s_start_ns : 0;
+            writeEvent(fmt::format(R"({{"name":"{}","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                                   zone.name,
+                                   tid,
+                                   toMicroseconds(begin_ns),
+                                   toMicroseconds(zone.end_ns - zone.begin_ns)));
+        };
+        while (s_buffers[tid]->zones.pop(writeZone)) {}
+    }
+}
+
+void writeThreadNames() {
+    for (auto tid = std::size_t{0}; tid < s_buffers.size(); ++tid) {
+        if (const auto* name = s_buffers[tid]->name.load(std::memory_order_acquire)) {
+            writeEvent(fmt::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})", tid, name));
+        }
+    }
+}
+
+#ifdef ENABLE_TRACING
+constexpr auto writeInterval = std::chrono::milliseconds(10);
+
+void writeLoop() {
+    while (s_running.load(std::memory_order_acquire)) {
+        drainBuffers();
+        std::this_thread::sleep_for(writeInterval);
+    }
+}
+#endif
+
+}
+
+namespace trace {
+
+std::uint64_t now_ns() noexcept {
+#if defined(__linux__)
+    auto time = timespec{};
+    clock_gettime(CLOCK_MONOTONIC_RAW, &time);
+    return static_cast<std::uint64_t>(time.tv_sec) * 1'000'000'000 + static_cast<std::uint64_t>(time.tv_nsec);
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+}
+
+void Trace::init(const std::string& path) {
+#ifndef ENABLE_TRACING
+    M_INFO("Tracing is disabled. Configure CMake with -DENABLE_TRACING=ON to enable it.");
+    static_cast<void>(path);
+#else
+    if (s_running.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    s_file = std::fopen(path.c_str(), "w");
+    if (!s_file) {
+        M_ERROR(fmt::format("Failed to open trace file '{}'.", path));
+        return;
+    }
+    fmt::print(s_file, R"({{"displayTimeUnit":"ms","traceEvents":[)");
+
+    if (!s_buffersAllocated.load(std::memory_order_acquire)) {
+        for (auto& buffer : s_buffers) {
+            buffer = std::make_unique<ThreadBuffer>();
+        }
+        s_buffersAllocated.store(true, std::memory_order_release);
+    } else {
+        // Traced before, and shut down: zones recorded since then belong to neither file. With no writer running,
+        // this is the only consumer.
+        for (auto& buffer : s_buffers) {
+            while (buffer->zones.pop([](const trace::Zone&) {})) {}
+        }
+    }
+
+    // A new file, so its first event mustn't be preceded by a comma.
+    s_numWrittenZones = 0;
+    s_numDroppedZones.store(0, std::memory_order_relaxed);
+    s_start_ns = trace::now_ns();
+    s_running.store(true, std::memory_order_release);
+    s_writer = std::thread(&writeLoop);
+    M_INFO(fmt::format("Tracing to {}.", path));
+#endif
+}
+
+void Trace::shutdown() {
+    if (!s_running.exchange(false)) {
+        return;
+    }
+
+    if (s_writer.joinable()) {
+        s_writer.join();
+    }
+
+    drainBuffers();
+    writeThreadNames();
+    fmt::print(s_file, "\n]}}\n");
+    std::fclose(s_file);
+    s_file = nullptr;
+
+    if (const auto numDropped = numDroppedZones(); numDropped > 0) {
+        M_WARN(fmt::format("{} trace zone(s) were dropped.", numDropped));
+    }
+}
+
+std::string Trace::getDefaultTracePath() {
+    return std::filesystem::path(Log::getDefaultLogfilePath()).replace_filename("microtone_trace.json").string();
+}
+
+void Trace::setThreadName(const char* name) noexcept {
+    if (auto* buffer = threadBuffer()) {
+        buffer->name.store(name, std::memory_order_release);
+    }
+}
+
+void Trace::record(const trace::Zone& zone) noexcept {
+    auto* buffer = threadBuffer();
+    if (!buffer) {
+        if (s_buffersAllocated.load(std::memory_order_relaxed)) {
+            s_numDroppedZones.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    if (!buffer->zones.push(zone)) {
+        s_numDroppedZones.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::size_t Trace::numDroppedZones() noexcept {
+    return s_numDroppedZones.load(std::memory_order_relaxed);
+}
+
+}
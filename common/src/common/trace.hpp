@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace common {
+
+namespace trace {
+
+//! Zones per thread buffered between passes of the writer. A thread that records faster than the writer drains drops
+//! zones (they're counted).
+constexpr std::size_t QueueSize = 4096;
+
+//! Buffers are preallocated in `Trace::init`, so only this many threads can record.
+constexpr std::size_t MaxThreads = 16;
+
+//! One completed zone. Names are stored by pointer and must outlive the trace (use literals).
+struct Zone {
+    const char* name;
+    std::uint64_t begin_ns;
+    std::uint64_t end_ns;
+};
+
+//! CLOCK_MONOTONIC_RAW where it exists: unlike the steady clock, it isn't slewed by NTP, so zones on different threads
+//! line up.
+[[nodiscard]] std::uint64_t now_ns() noexcept;
+
+}
+
+//! Records timed zones from any thread onto one timeline, written as Chrome trace JSON (open it in chrome://tracing or
+//! ui.perfetto.dev).
+//! Each thread records into its own preallocated SPSC buffer, so recording never locks or allocates. A background
+//! thread drains the buffers and writes the file. Use the macros below; without ENABLE_TRACING they compile to nothing.
+class Trace {
+public:
+    //! Preallocates the buffers, opens `path` and starts the writer. Does nothing without ENABLE_TRACING.
+    //! After `shutdown`, starts a new file: zones recorded in between are discarded, and the dropped count restarts.
+    static void init(const std::string& path);
+
+    //! Writes any remaining zones and closes the file.
+    static void shutdown();
+
+    //! Next to the log file.
+    [[nodiscard]] static std::string getDefaultTracePath();
+
+    //! Names the calling thread on the timeline. Doesn't allocate or lock, so it's safe to call at the top of every
+    //! callback. The name must be a literal.
+    static void setThreadName(const char* name) noexcept;
+
+    static void record(const trace::Zone& zone) noexcept;
+
+    //! Zones dropped because a buffer was full or no buffer was available.
+    [[nodiscard]] static std::size_t numDroppedZones() noexcept;
+};
+
+//! Records the time between its construction and destruction. Use M_TRACE_ZONE.
+class TraceZone {
+public:
+    explicit TraceZone(const char* name) noexcept :
+        _name{name},
+        _begin_ns{trace::now_ns()} {}
+
+    ~TraceZone() {
+        Trace::record({_name, _begin_ns, trace::now_ns()});
+    }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char* _name;
+    std::uint64_t _begin_ns;
+};
+
+}
+
+#define M_TRACE_CONCAT_IMPL(a, b) a##b
+#define M_TRACE_CONCAT(a, b) M_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef ENABLE_TRACING
+#define M_TRACE_ZONE(name) ::common::TraceZone M_TRACE_CONCAT(traceZone_, __LINE__){name}
+#define M_TRACE_THREAD(name) ::common::Trace::setThreadName(name)
+#else
+#define M_TRACE_ZONE(name) static_cast<void>(0)
+#define M_TRACE_THREAD(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+
+namespace common {
+
+//! Publishes the latest T from writers to a single reader (the audio thread).
+//! The reader never blocks or retries: it sees either the newest published value or the one it saw last time.
+//! Writers are serialized with a mutex, so they may wait on each other, but never on the reader.
+template <typename T>
+class TripleBuffer {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T& value) :
+        _buffers{value, value, value},
+        _latest{value} {}
+
+    //! Publishes `value`.
+    void write(const T& value) {
+        auto lock = std::unique_lock(_writerMutex);
+        publish(value);
+    }
+
+    //! Publishes a copy of the last written value, modified by `mutate`.
+    template <typename Fn>
+    void update(Fn&& mutate) {
+        auto lock = std::unique_lock(_writerMutex);
+        auto value = _latest;
+        std::invoke(std::forward<Fn>(mutate), value);
+        publish(value);
+    }
+
+    //! Returns the newest value. Only one thread may call this.
+    [[nodiscard]] const T& read() noexcept {
+        if (_shared.load(std::memory_order_relaxed) & DirtyBit) {
+            _readIndex = _shared.exchange(_readIndex, std::memory_order_acq_rel) & IndexMask;
+        }
+        return _buffers[_readIndex];
+    }
+
+    //! True if a value was published since the last `read`.
+    [[nodiscard]] bool hasChanges() const noexcept {
+        return _shared.load(std::memory_order_relaxed) & DirtyBit;
+    }
+
+private:
+    static constexpr std::uint8_t DirtyBit = 0b100;
+    static constexpr std::uint8_t IndexMask = 0b011;
+
+    void publish(const T& value) {
+        _latest = value;
+        _buffers[_writeIndex] = value;
+        _writeIndex = _shared.exchange(_writeIndex | DirtyBit, std::memory_order_acq_rel) & IndexMask;
+    }
+
+    std::array<T, 3> _buffers{};
+
+    // Writer side.
+    std::mutex _writerMutex;
+    T _latest{};
+    std::uint8_t _writeIndex{0};
+
+    //! The index of the buffer not held by either side, plus whether it holds an unread value.
+    alignas(64) std::atomic<std::uint8_t> _shared{2};
+
+    // Reader side.
+    alignas(64) std::uint8_t _readIndex{1};
+};
+
+}
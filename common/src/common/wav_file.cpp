@@ -0,0 +1,273 @@
+#include <common/wav_file.hpp>
+
+#include <common/exception.hpp>
+#include <common/log.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+namespace common::audio {
+
+namespace {
+
+constexpr std::uint16_t WaveFormatPCM = 0x0001;
+constexpr std::uint16_t WaveFormatIEEEFloat = 0x0003;
+constexpr std::uint16_t WaveFormatExtensible = 0xFFFE;
+
+//! WAV is little-endian, regardless of the host.
+[[nodiscard]] std::uint32_t readLittleEndian(const unsigned char* p, std::size_t numBytes) {
+    auto result = std::uint32_t{0};
+    for (auto i = std::size_t{0}; i < numBytes; ++i) {
+        result |= static_cast<std::uint32_t>(p[i]) << (8 * i);
+    }
+    return result;
+}
+
+void writeLittleEndian(std::vector<unsigned char>& out, std::uint32_t value, std::size_t numBytes) {
+    for (auto i = std::size_t{0}; i < numBytes; ++i) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+void writeTag(std::vector<unsigned char>& out, std::string_view tag) {
+    out.insert(out.end(), tag.begin(), tag.end());
+}
+
+[[nodiscard]] bool hasTag(const unsigned char* p, std::string_view tag) {
+    return std::memcmp(p, tag.data(), tag.size()) == 0;
+}
+
+struct Format {
+    std::uint16_t encoding{0};
+    std::uint16_t numChannels{0};
+    std::uint32_t sampleRate{0};
+    std::uint16_t bitsPerSample{0};
+};
+
+[[nodiscard]] Format parseFormat(const unsigned char* p, std::size_t size) {
+    if (size < 16) {
+        throw MicrotoneException("WAV fmt chunk is too short.");
+    }
+    auto result = Format{
+        static_cast<std::uint16_t>(readLittleEndian(p, 2)),
+        static_cast<std::uint16_t>(readLittleEndian(p + 2, 2)),
+        readLittleEndian(p + 4, 4),
+        static_cast<std::uint16_t>(readLittleEndian(p + 14, 2))};
+
+    // The real encoding of an extensible file is the first two bytes of its sub-format GUID.
+    if (result.encoding == WaveFormatExtensible) {
+        if (size < 26) {
+            throw MicrotoneException("WAV extensible fmt chunk is too short.");
+        }
+        result.encoding = static_cast<std::uint16_t>(readLittleEndian(p + 24, 2));
+    }
+    return result;
+}
+
+//! RIFF header, an 18 byte fmt chunk, a fact chunk (required for non-PCM data), and the data chunk's header.
+constexpr std::size_t FloatHeaderSize = 12 + (8 + 18) + (8 + 4) + 8;
+
+[[nodiscard]] std::vector<unsigned char> encodeFloatHeader(double sampleRate, std::size_t numChannels, std::uint64_t numSamples) {
+    constexpr auto bytesPerSample = std::uint32_t{sizeof(float)};
+    const auto dataSize = static_cast<std::uint32_t>(numSamples * bytesPerSample);
+    const auto rate = static_cast<std::uint32_t>(sampleRate);
+    const auto channels = static_cast<std::uint32_t>(numChannels);
+
+    auto result = std::vector<unsigned char>{};
+    result.reserve(FloatHeaderSize);
+    writeTag(result, "RIFF");
+    writeLittleEndian(result, static_cast<std::uint32_t>(FloatHeaderSize - 8 + dataSize), 4);
+    writeTag(result, "WAVE");
+
+    writeTag(result, "fmt ");
+    writeLittleEndian(result, 18, 4);
+    writeLittleEndian(result, WaveFormatIEEEFloat, 2);
+    writeLittleEndian(result, channels, 2);
+    writeLittleEndian(result, rate, 4);
+    writeLittleEndian(result, rate * channels * bytesPerSample, 4);
+    writeLittleEndian(result, channels * bytesPerSample, 2);
+    writeLittleEndian(result, 8 * bytesPerSample, 2);
+    writeLittleEndian(result, 0, 2);
+
+    writeTag(result, "fact");
+    writeLittleEndian(result, 4, 4);
+    writeLittleEndian(result, static_cast<std::uint32_t>(numSamples / numChannels), 4);
+
+    writeTag(result, "data");
+    writeLittleEndian(result, dataSize, 4);
+    return result;
+}
+
+[[nodiscard]] SampleT decodeSample(const unsigned char* p, const Format& format) {
+    switch (format.bitsPerSample) {
+    case 16:
+        return static_cast<SampleT>(static_cast<std::int16_t>(readLittleEndian(p, 2))) / 32768.f;
+    case 24: {
+        // Sign-extend by shifting the 24 bits to the top of an int32.
+        const auto value = static_cast<std::int32_t>(readLittleEndian(p, 3) << 8) >> 8;
+        return static_cast<SampleT>(value) / 8388608.f;
+    }
+    case 32:
+        if (format.encoding == WaveFormatIEEEFloat) {
+            const auto bits = readLittleEndian(p, 4);
+            auto value = 0.f;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+        return static_cast<SampleT>(static_cast<double>(static_cast<std::int32_t>(readLittleEndian(p, 4))) / 2147483648.0);
+    default:
+        return 0.f;
+    }
+}
+
+}
+
+std::vector<SampleT> WavFile::toMono() const {
+    auto result = std::vector<SampleT>(numFrames(), 0.f);
+    for (auto frame = std::size_t{0}; frame < result.size(); ++frame) {
+        for (auto channel = std::size_t{0}; channel < numChannels; ++channel) {
+            result[frame] += samples[frame * numChannels + channel];
+        }
+        result[frame] /= static_cast<SampleT>(numChannels);
+    }
+    return result;
+}
+
+WavFile readWavFile(const std::filesystem::path& path) {
+    auto stream = std::ifstream(path, std::ios::binary);
+    if (!stream) {
+        throw MicrotoneException("Failed to open WAV file: " + path.string());
+    }
+    const auto bytes = std::vector<unsigned char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+    if (bytes.size() < 12 || !hasTag(bytes.data(), "RIFF") || !hasTag(bytes.data() + 8, "WAVE")) {
+        throw MicrotoneException("Not a RIFF/WAVE file: " + path.string());
+    }
+
+    auto format = std::optional<Format>{};
+    const unsigned char* data = nullptr;
+    auto dataSize = std::size_t{0};
+
+    // Chunks are word aligned; anything that isn't fmt or data (LIST, fact, cue...) is skipped.
+    for (auto offset = std::size_t{12}; offset + 8 <= bytes.size();) {
+        const auto* chunk = bytes.data() + offset;
+        const auto chunkSize = std::min<std::size_t>(readLittleEndian(chunk + 4, 4), bytes.size() - offset - 8);
+        if (hasTag(chunk, "fmt ")) {
+            format = parseFormat(chunk + 8, chunkSize);
+        } else if (hasTag(chunk, "data")) {
+            data = chunk + 8;
+            dataSize = chunkSize;
+        }
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (!format || !data) {
+        throw MicrotoneException("WAV file is missing its fmt or data chunk: " + path.string());
+    }
+    if (format->encoding != WaveFormatPCM && format->encoding != WaveFormatIEEEFloat) {
+        throw MicrotoneException("Only PCM and float WAV files are supported: " + path.string());
+    }
+    if (format->bitsPerSample != 16 && format->bitsPerSample != 24 && format->bitsPerSample != 32) {
+        throw MicrotoneException("Only 16, 24 and 32 bit WAV files are supported: " + path.string());
+    }
+    if (format->encoding == WaveFormatIEEEFloat && format->bitsPerSample != 32) {
+        throw MicrotoneException("Only 32 bit float WAV files are supported: " + path.string());
+    }
+    if (format->numChannels == 0 || format->sampleRate == 0) {
+        throw MicrotoneException("WAV file has no channels or no sample rate: " + path.string());
+    }
+
+    const auto bytesPerSample = std::size_t{format->bitsPerSample} / 8;
+    auto result = WavFile{};
+    result.sampleRate = format->sampleRate;
+    result.numChannels = format->numChannels;
+    result.samples.resize(dataSize / bytesPerSample / format->numChannels * format->numChannels);
+    for (auto i = std::size_t{0}; i < result.samples.size(); ++i) {
+        result.samples[i] = decodeSample(data + i * bytesPerSample, *format);
+    }
+    return result;
+}
+
+WavFileWriter::WavFileWriter(const std::filesystem::path& path, double sampleRate, std::size_t numChannels) :
+    _path{path},
+    _stream{path, std::ios::binary | std::ios::trunc},
+    _sampleRate{sampleRate},
+    _numChannels{numChannels} {
+    if (!_stream) {
+        throw MicrotoneException("Failed to open WAV file for writing: " + path.string());
+    }
+    if (numChannels == 0 || sampleRate <= 0) {
+        throw MicrotoneException("A WAV file needs at least one channel and a sample rate: " + path.string());
+    }
+
+    // A placeholder until the sizes are known.
+    const auto header = encodeFloatHeader(_sampleRate, _numChannels, 0);
+    _stream.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    _buffer.reserve(BufferSize);
+}
+
+WavFileWriter::~WavFileWriter() {
+    try {
+        close();
+    } catch (const MicrotoneException& e) {
+        M_ERROR(e.what());
+    }
+}
+
+void WavFileWriter::write(std::span<const SampleT> samples) {
+    if (!_stream.is_open()) {
+        throw MicrotoneException("WAV file is closed: " + _path.string());
+    }
+    // RIFF sizes are 32 bit.
+    if ((_numSamples + samples.size()) * sizeof(float) > UINT32_MAX - FloatHeaderSize) {
+        throw MicrotoneException("WAV file would exceed 4 GiB: " + _path.string());
+    }
+
+    for (auto offset = std::size_t{0}; offset < samples.size();) {
+        if (_buffer.size() == BufferSize) {
+            flush();
+        }
+        const auto count = std::min(samples.size() - offset, (BufferSize - _buffer.size()) / sizeof(float));
+        const auto* first = reinterpret_cast<const unsigned char*>(samples.data() + offset);
+        if constexpr (std::endian::native == std::endian::little) {
+            _buffer.insert(_buffer.end(), first, first + count * sizeof(float));
+        } else {
+            for (auto i = std::size_t{0}; i < count; ++i) {
+                writeLittleEndian(_buffer, std::bit_cast<std::uint32_t>(samples[offset + i]), 4);
+            }
+        }
+        offset += count;
+    }
+    _numSamples += samples.size();
+}
+
+void WavFileWriter::close() {
+    if (!_stream.is_open()) {
+        return;
+    }
+    flush();
+
+    const auto header = encodeFloatHeader(_sampleRate, _numChannels, _numSamples);
+    _stream.seekp(0);
+    _stream.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    _stream.close();
+    if (!_stream) {
+        throw MicrotoneException("Failed to write WAV file: " + _path.string());
+    }
+}
+
+void WavFileWriter::flush() {
+    _stream.write(reinterpret_cast<const char*>(_buffer.data()), static_cast<std::streamsize>(_buffer.size()));
+    _buffer.clear();
+    if (!_stream) {
+        throw MicrotoneException("Failed to write WAV file: " + _path.string());
+    }
+}
+
+}
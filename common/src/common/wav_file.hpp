@@ -0,0 +1,76 @@
+#pragma once
+
+#include "common/ring_buffer.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+namespace common::audio {
+
+//! The decoded contents of a WAV file. Samples are interleaved and scaled to [-1, 1].
+struct WavFile {
+    double sampleRate{0};
+    std::size_t numChannels{0};
+    std::vector<SampleT> samples;
+
+    [[nodiscard]] std::size_t numFrames() const {
+        return numChannels == 0 ? 0 : samples.size() / numChannels;
+    }
+
+    [[nodiscard]] double duration_s() const {
+        return sampleRate == 0 ? 0 : static_cast<double>(numFrames()) / sampleRate;
+    }
+
+    //! The average of all channels.
+    [[nodiscard]] std::vector<SampleT> toMono() const;
+};
+
+//! Reads an uncompressed RIFF/WAVE file: 16, 24 or 32 bit integer PCM, or 32 bit float.
+//! Throws a MicrotoneException if the file can't be read or uses an unsupported format.
+[[nodiscard]] WavFile readWavFile(const std::filesystem::path& path);
+
+//! Streams 32 bit float samples into a RIFF/WAVE file. Writes go through a fixed buffer, so the file sees a few large
+//! writes rather than one per block; the header's sizes are filled in on `close`.
+//! Throws a MicrotoneException if the file can't be written.
+class WavFileWriter {
+public:
+    //! Bytes buffered between writes to the file.
+    static constexpr std::size_t BufferSize = 1 << 16;
+
+    WavFileWriter(const std::filesystem::path& path, double sampleRate, std::size_t numChannels = 1);
+
+    //! Closes the file, if it's still open. Errors are logged rather than thrown.
+    ~WavFileWriter();
+
+    WavFileWriter(const WavFileWriter&) = delete;
+    WavFileWriter& operator=(const WavFileWriter&) = delete;
+
+    //! Appends interleaved samples.
+    void write(std::span<const SampleT> samples);
+
+    //! Flushes the buffer and completes the header. Further writes throw.
+    void close();
+
+    [[nodiscard]] std::size_t numFrames() const {
+        return _numSamples / _numChannels;
+    }
+
+    [[nodiscard]] double duration_s() const {
+        return static_cast<double>(numFrames()) / _sampleRate;
+    }
+
+private:
+    void flush();
+
+    std::filesystem::path _path;
+    std::ofstream _stream;
+    double _sampleRate;
+    std::size_t _numChannels;
+    std::vector<unsigned char> _buffer;
+    std::uint64_t _numSamples{0};
+};
+
+}
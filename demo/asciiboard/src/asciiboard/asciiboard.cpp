@@ -13,10 +13,12 @@
 #include "asciiboard/components/envelope_controls.hpp"
 #include "asciiboard/components/envelope_graph.hpp"
 #include "asciiboard/components/info_message.hpp"
+#include "asciiboard/components/level_meters.hpp"
 #include "asciiboard/components/oscillator_controls.hpp"
 #include "asciiboard/components/oscilloscope.hpp"
 #include "asciiboard/components/compact_piano_roll.hpp"
 #include "common/log.hpp"
+#include "common/trace.hpp"
 
 #include <string>
 
@@ -60,10 +62,11 @@ class Asciiboard::impl {
     }
 
 public:
-    explicit impl(const State& initialControls, double sampleRate) :
+    impl(const State& initialControls, double sampleRate, std::shared_ptr<const synth::LevelMeter> levelMeter) :
         _screen{ScreenInteractive::Fullscreen()},
         _controls{std::make_unique<State>(initialControls)},
-        _oscilloscope(sampleRate, graphWidth, graphHeight, _controls) {}
+        _oscilloscope(sampleRate, graphWidth, graphHeight, _controls),
+        _levelMeters(std::move(levelMeter)) {}
 
     void addOutputData(const common::audio::FrameBlock& audioBlock) {
         _oscilloscope.addAudioBlock(audioBlock);
@@ -164,10 +167,16 @@ public:
                    }) | borderRounded | color(Color::BlueLight);
         });
 
+        // =========== Level Meters ===========
+        auto levelMeters = _levelMeters.component();
+
         auto mainRenderer = Renderer(tabContent, [&] {
+            M_TRACE_THREAD("UI");
+            M_TRACE_ZONE("Render");
             Element document = vbox({text("microtone") | bold | hcenter,
                                      tabBar->Render(),
                                      tabContent->Render(),
+                                     levelMeters->Render(),
                                      pianoRoll->Render()});
 
             if (_controls->showInfoMessage) {
@@ -243,11 +252,12 @@ public:
     ScreenInteractive _screen;
     std::shared_ptr<State> _controls;
     Oscilloscope _oscilloscope;
+    LevelMeters _levelMeters;
     CompactPianoRoll _pianoRoll;
 };
 
-Asciiboard::Asciiboard(const State& initialControls, double sampleRate) :
-    _impl{std::make_unique<impl>(initialControls, sampleRate)} {};
+Asciiboard::Asciiboard(const State& initialControls, double sampleRate, std::shared_ptr<const synth::LevelMeter> levelMeter) :
+    _impl{std::make_unique<impl>(initialControls, sampleRate, std::move(levelMeter))} {};
 
 Asciiboard::Asciiboard(Asciiboard&& other) noexcept :
     _impl{std::move(other._impl)} {
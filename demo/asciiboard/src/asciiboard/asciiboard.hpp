@@ -9,6 +9,7 @@
 
 #include <common/midi_handle.hpp>
 #include <common/ring_buffer.hpp>
+#include <synth/effects/level_meter.hpp>
 
 namespace asciiboard {
 
@@ -17,7 +18,7 @@ using OnAboutToQuitFn = std::function<void()>;
 
 class Asciiboard {
 public:
-    Asciiboard(const State& initialControls, double sampleRate);
+    Asciiboard(const State& initialControls, double sampleRate, std::shared_ptr<const synth::LevelMeter> levelMeter);
     Asciiboard(const Asciiboard&) = delete;
     Asciiboard& operator=(const Asciiboard&) = delete;
     Asciiboard(Asciiboard&&) noexcept;
@@ -15,8 +15,11 @@ struct SelectableEffectsControls : I_UIControls {
              &_state->delay_ms,
              &_state->filterTypeIndex,
              &_state->filterCutoffFrequency,
+             &_state->filterResonance,
              &_state->filterLfoDepth,
-             &_state->filterLfoFrequency}} {}
+             &_state->filterLfoFrequency,
+             &_state->reverbDecay_s,
+             &_state->reverbWet}} {}
 
     [[nodiscard]] I_Incrementable& currentControl() override {
         return _controls.currentItem();
@@ -41,7 +44,7 @@ public:
         _width(width),
         _height(height),
         _controls(controls),
-        _filterStrings{"Low Pass", "High Pass"} {}
+        _filterStrings{"Low Pass", "High Pass", "Band Pass", "Notch"} {}
 
     [[nodiscard]] ftxui::Component component() const {
         using namespace ftxui;
@@ -69,6 +72,13 @@ public:
             _controls->filterCutoffFrequency.max,
             _controls->filterCutoffFrequency.incrementAmount);
 
+        auto filterResonance = Slider(
+            "Resonance:",
+            &_controls->filterResonance.value,
+            _controls->filterResonance.min,
+            _controls->filterResonance.max,
+            _controls->filterResonance.incrementAmount);
+
         auto filterLfoDepth = Slider(
             "LFO Depth (Hz):",
             &_controls->filterLfoDepth.value,
@@ -83,12 +93,29 @@ public:
             _controls->filterLfoFrequency.max,
             _controls->filterLfoFrequency.incrementAmount);
 
+        auto reverbDecay = Slider(
+            "Reverb decay (s):",
+            &_controls->reverbDecay_s.value,
+            _controls->reverbDecay_s.min,
+            _controls->reverbDecay_s.max,
+            _controls->reverbDecay_s.incrementAmount);
+
+        auto reverbWet = Slider(
+            "Reverb mix:",
+            &_controls->reverbWet.value,
+            _controls->reverbWet.min,
+            _controls->reverbWet.max,
+            _controls->reverbWet.incrementAmount);
+
         auto controlsContainer = Container::Tab({delayGainSlider,
                                                  delaySlider,
                                                  filterType,
                                                  filterCutoffFrequency,
+                                                 filterResonance,
                                                  filterLfoDepth,
-                                                 filterLfoRate},
+                                                 filterLfoRate,
+                                                 reverbDecay,
+                                                 reverbWet},
                                                 _controls->selectedEffectControl.get());
 
         return Renderer(controlsContainer, [=] {
@@ -102,9 +129,15 @@ public:
                              filler() | size(HEIGHT, EQUAL, 1),
                              filterType->Render() | color(Color::GrayDark),
                              filterCutoffFrequency->Render(),
+                             filterResonance->Render(),
                              filterLfoDepth->Render(),
                              filterLfoRate->Render(),
-                         })}) |
+                         }),
+                         filler() | size(HEIGHT, EQUAL, 2),
+                         vbox({text("Reverb"),
+                               filler() | size(HEIGHT, EQUAL, 1),
+                               reverbDecay->Render(),
+                               reverbWet->Render()})}) |
                    borderRounded | color(Color::BlueLight);
         });
     }
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+
+#include "synth/effects/level_meter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace asciiboard {
+
+namespace detail {
+
+constexpr auto meterFloor_dB = -60.f;
+
+[[nodiscard]] inline float toDecibels(float amplitude) {
+    return 20.f * std::log10(std::max(amplitude, 1e-6f));
+}
+
+//! Maps [meterFloor_dB, 0] dBFS onto [0, 1].
+[[nodiscard]] inline float toGaugeValue(float amplitude) {
+    return std::clamp((toDecibels(amplitude) - meterFloor_dB) / -meterFloor_dB, 0.f, 1.f);
+}
+
+}
+
+//! Peak and RMS meters. Readings are polled from the meter node on every render; nothing is copied in between.
+class LevelMeters {
+public:
+    explicit LevelMeters(std::shared_ptr<const synth::LevelMeter> meter) :
+        _meter(std::move(meter)) {}
+
+    [[nodiscard]] ftxui::Component component() const {
+        using namespace ftxui;
+
+        return Renderer([this] {
+            const auto reading = _meter->reading();
+            const auto meterRow = [](const std::string& label, float amplitude) {
+                return hbox({text(label) | size(WIDTH, EQUAL, 6),
+                             gauge(detail::toGaugeValue(amplitude)) | flex | color(amplitude > 1.f ? Color::RedLight : Color::GreenLight),
+                             text(fmt::format(" {:6.1f} dBFS", detail::toDecibels(amplitude)))});
+            };
+
+            return vbox({meterRow("Peak", reading.peak),
+                         meterRow("RMS", reading.rms),
+                         text(fmt::format("Clipped: {}  NaN/Inf: {}", reading.numClipped, reading.numNonFinite)) | color(Color::GrayDark)}) |
+                   borderRounded | color(Color::BlueLight);
+        });
+    }
+
+private:
+    std::shared_ptr<const synth::LevelMeter> _meter;
+};
+
+}
@@ -3,6 +3,7 @@
 #include <ftxui/component/component.hpp>
 
 #include "common/dirty_flagged.hpp"
+#include "common/mutex_protected.hpp"
 #include "common/sliding_window.hpp"
 
 namespace asciiboard {
@@ -67,14 +68,15 @@ template <typename Range>
                                               int height,
                                               std::size_t windowSize,
                                               float scaleFactor,
-                                              const std::vector<common::audio::FrameBlock>& blocks) {
+                                              const common::SlidingWindow<common::audio::FrameBlock>::View& blocks) {
     auto result = ftxui::Canvas(width, height);
-    for (auto blockIndex = 0; blockIndex < blocks.size(); ++blockIndex) {
+    auto blockIndex = std::size_t{0};
+    for (const auto& block : blocks) {
         for (auto i = 0; i < common::audio::AudioBlockSize - 1; ++i) {
             const auto x0 = getXValueOnCanvas(blockIndex, i, windowSize, width);
-            const auto y0 = getYValueOnCanvas(blocks.at(blockIndex).at(i), scaleFactor, height);
+            const auto y0 = getYValueOnCanvas(block[i], scaleFactor, height);
             const auto x1 = getXValueOnCanvas(blockIndex, i + 1, windowSize, width);
-            const auto y1 = getYValueOnCanvas(blocks.at(blockIndex).at(i + 1), scaleFactor, height);
+            const auto y1 = getYValueOnCanvas(block[i + 1], scaleFactor, height);
 
             // Skip points that are out of range.
             if ((y0 < 0 && y1 < 0) || (y0 > height && y1 > height)) {
@@ -87,6 +89,7 @@ template <typename Range>
                                  std::clamp(y1, 0, height),
                                  ftxui::Color::Purple);
         }
+        ++blockIndex;
     }
     return result;
 }
@@ -120,12 +123,14 @@ public:
         auto timelineScaleSelector = Menu(&_millisecondStrings, &_controls->oscilloscopeTimelineSizeIndex, toggleOption);
         auto toggleLive = Checkbox("Live", &_controls->isOscilloscopeLive);
         auto stepBack = Button("-10ms", [this] {
-            auto& blockWindow = _blockWindow.getWritable();
+            auto flaggedWindow = _blockWindow.lockForWrite();
+            auto& blockWindow = flaggedWindow->getWritable();
             if (!_controls->isOscilloscopeLive && blockWindow.hasPrevious()) {
                 blockWindow.stepBack();
             } }, ButtonOption::Ascii());
         auto stepForward = Button("+10ms", [this] {
-            auto& blockWindow = _blockWindow.getWritable();
+            auto flaggedWindow = _blockWindow.lockForWrite();
+            auto& blockWindow = flaggedWindow->getWritable();
             if (!_controls->isOscilloscopeLive && blockWindow.hasNext()) {
                 blockWindow.stepForward();
             } }, ButtonOption::Ascii());
@@ -134,9 +139,13 @@ public:
         auto oscilloscopeControlsContainer = Container::Horizontal({scaleFactorSelector, timelineScaleSelector, toggleLive, stepBack, stepForward});
 
         auto canvasComponent = Renderer([=, this] {
-            if (_blockWindow.dirty) {
+            // Locked while drawing: the view below reads the history in place, and the render loop's pushes would
+            // overwrite it. They wait, which costs nothing but a late frame.
+            auto flaggedWindow = _blockWindow.lockForWrite();
+            if (flaggedWindow->dirty) {
                 const auto windowSize = detail::blocksToShow[_controls->oscilloscopeTimelineSizeIndex];
-                const auto currentWindow = _blockWindow.getReadable().currentWindow(windowSize);
+                // A view into the history; nothing is copied.
+                const auto currentWindow = flaggedWindow->getReadable().currentWindow(windowSize);
                 _canvas = detail::makeCanvas(
                     _graphWidth,
                     _graphHeight,
@@ -171,9 +180,11 @@ public:
         });
     }
 
+    //! Called from the render loop's thread, while the UI thread renders.
     void addAudioBlock(const common::audio::FrameBlock& block) {
         if (_controls->isOscilloscopeLive) {
-            auto& blockWindow = _blockWindow.getWritable();
+            auto flaggedWindow = _blockWindow.lockForWrite();
+            auto& blockWindow = flaggedWindow->getWritable();
             blockWindow.push(block);
             const auto windowSize = detail::blocksToShow[_controls->oscilloscopeTimelineSizeIndex];
             if (blockWindow.getCurrentIndex() + windowSize < blockWindow.size()) {
@@ -191,7 +202,8 @@ private:
     std::vector<std::string> _millisecondStrings;
 
     using BlockWindow = common::SlidingWindow<common::audio::FrameBlock>;
-    common::SingleReaderDirtyFlagged<BlockWindow> _blockWindow{BlockWindow{200}};
+    using FlaggedBlockWindow = common::SingleReaderDirtyFlagged<BlockWindow>;
+    common::MutexProtected<FlaggedBlockWindow> _blockWindow{FlaggedBlockWindow{BlockWindow{200}}};
     ftxui::Canvas _canvas;
 };
 
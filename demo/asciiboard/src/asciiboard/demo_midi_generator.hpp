@@ -97,7 +97,7 @@ struct MidiGeneratorOptions {
 class MidiGenerator {
 public:
     MidiGenerator() = delete;
-    explicit MidiGenerator(std::shared_ptr<common::midi::TwoReaderMidiHandle> midiHandle, MidiGeneratorOptions options) :
+    explicit MidiGenerator(std::shared_ptr<common::midi::MidiHandle> midiHandle, MidiGeneratorOptions options) :
         _midiHandle(std::move(midiHandle)),
         _options(options) {}
 
@@ -167,7 +167,7 @@ private:
         }
     }
 
-    std::shared_ptr<common::midi::TwoReaderMidiHandle> _midiHandle;
+    std::shared_ptr<common::midi::MidiHandle> _midiHandle;
     MidiGeneratorOptions _options;
 
     std::atomic<bool> _running{false};
@@ -4,20 +4,36 @@
 
 #include <common/exception.hpp>
 #include <common/log.hpp>
+#include <common/midi_file.hpp>
+#include <common/trace.hpp>
 
 #include <io/audio_output_stream.hpp>
 #include <io/gpio_input.hpp>
 #include <io/midi_input_stream.hpp>
+#include <io/null_audio_backend.hpp>
+#include <io/portaudio_backend.hpp>
 
 #include <synth/instrument.hpp>
+#include <synth/midi_file_player.hpp>
 #include <synth/wave_table.hpp>
+#include <synth/effects/convolution_reverb.hpp>
 #include <synth/effects/delay.hpp>
+#include <synth/effects/fdn_reverb.hpp>
+#include <synth/effects/level_meter.hpp>
+#include <synth/effects/limiter.hpp>
 #include <synth/effects/modulated_filter.hpp>
+#include <synth/effects/tap.hpp>
 
 #include <fmt/format.h>
 
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <filesystem>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <string_view>
 
 namespace {
 
@@ -55,6 +71,39 @@ namespace {
     return result;
 }
 
+//! The value of `argument`, if it's `--name=value`. Throws a MicrotoneException if the value isn't a non-negative number.
+[[nodiscard]] std::optional<double> parseOption(std::string_view argument, std::string_view name) {
+    const auto prefix = fmt::format("--{}=", name);
+    if (!argument.starts_with(prefix)) {
+        return std::nullopt;
+    }
+    const auto value = std::string{argument.substr(prefix.size())};
+    try {
+        auto numParsed = std::size_t{0};
+        if (const auto result = std::stod(value, &numParsed); numParsed == value.size() && result >= 0) {
+            return result;
+        }
+    } catch (const std::logic_error&) {
+        // Reported below.
+    }
+    throw common::MicrotoneException(fmt::format("Invalid value for --{}: '{}'.", name, value));
+}
+
+//! Lists the output devices, for choosing an io::AudioStreamConfiguration.
+void logOutputDevices() {
+    for (const auto& device : io::PortAudioBackend::outputDevices()) {
+        M_INFO(fmt::format("Output device {}: '{}' ({}), {} channel(s), {} Hz, {:.1f}-{:.1f} ms latency{}.",
+                           device.index,
+                           device.name,
+                           device.hostApi,
+                           device.maxOutputChannels,
+                           device.defaultSampleRate,
+                           1000 * device.defaultLowOutputLatency_s,
+                           1000 * device.defaultHighOutputLatency_s,
+                           device.isDefaultOutput ? " (default)" : ""));
+    }
+}
+
 //! Selects a midi port automatically, if possible. Awaits user input if there are multiple ports available.
 //! The blackList can be used to ignore virtual midi ports so they're not automatically selected.
 void trySelectPort(io::MidiInputStream& midiInput, const std::vector<std::string>& blacklist) {
@@ -73,25 +122,68 @@ void trySelectPort(io::MidiInputStream& midiInput, const std::vector<std::string
 
 }
 
-int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
+int main(int argc, char* argv[]) {
     common::Log::init(/* enableConsoleLogging= */ false);
     M_INFO(fmt::format("Started logging: {}", common::Log::getDefaultLogfilePath()));
+    common::Trace::init(common::Trace::getDefaultTracePath());
 
     try {
+        // asciiboard [impulse_response.wav] [performance.mid] [--null-audio] [--jitter-us=N] [--stall-probability=P]
+        //            [--stall-us=N]
+        // Files can come in either order: they're told apart by their extensions. The options play through
+        // io::NullAudioBackend, with callbacks up to N us late and, with probability P per callback, stalled for N us.
+        auto impulseResponsePath = std::optional<std::filesystem::path>{};
+        auto midiFilePath = std::optional<std::filesystem::path>{};
+        auto nullAudioOptions = std::optional<io::NullAudioBackend::Options>{};
+        for (auto i = 1; i < argc; ++i) {
+            if (const auto option = std::string_view{argv[i]}; option.starts_with("--")) {
+                if (!nullAudioOptions) {
+                    nullAudioOptions.emplace();
+                }
+                if (const auto jitter_us = parseOption(option, "jitter-us")) {
+                    nullAudioOptions->maxJitter = std::chrono::microseconds{std::llround(*jitter_us)};
+                } else if (const auto probability = parseOption(option, "stall-probability")) {
+                    nullAudioOptions->stallProbability = std::min(*probability, 1.);
+                } else if (const auto stall_us = parseOption(option, "stall-us")) {
+                    nullAudioOptions->stallDuration = std::chrono::microseconds{std::llround(*stall_us)};
+                } else if (option != "--null-audio") {
+                    throw common::MicrotoneException(fmt::format("Unknown option: {}", option));
+                }
+                continue;
+            }
+
+            const auto argument = std::filesystem::path{argv[i]};
+            if (argument.extension() == ".mid" || argument.extension() == ".midi") {
+                midiFilePath = argument;
+            } else {
+                impulseResponsePath = argument;
+            }
+        }
+
         // The audio output thread is created and started. We do this first to find out the sample rate.
-        auto outputBufferHandle = std::make_shared<common::RingBuffer<common::audio::FrameBlock>>();
-        auto audioOutputStream = io::AudioOutputStream{outputBufferHandle};
+        // Room for four blocks (~43 ms at 48 kHz) between the instrument and the device.
+        // Pass an io::AudioStreamConfiguration to io::PortAudioBackend to choose the device, format and latency.
+        logOutputDevices();
+        auto outputBufferHandle = std::make_shared<common::SampleFifo>(4 * common::audio::AudioBlockSize);
+        auto audioOutputStream = nullAudioOptions
+                                     ? io::AudioOutputStream{outputBufferHandle, std::make_unique<io::NullAudioBackend>(*nullAudioOptions)}
+                                     : io::AudioOutputStream{outputBufferHandle};
+        if (audioOutputStream.createStreamError() == io::AudioStreamError::NoDevice) {
+            // Without a sound card, the null backend keeps the whole realtime path running, silently.
+            M_WARN("No audio output device is available. Continuing without sound.");
+            audioOutputStream = io::AudioOutputStream{outputBufferHandle, std::make_unique<io::NullAudioBackend>()};
+        }
         if (audioOutputStream.createStreamError() != io::AudioStreamError::NoError) {
             throw common::MicrotoneException("Failed to create audio output stream.");
         }
         const auto sampleRate = audioOutputStream.sampleRate();
 
         // The midi thread is created and started.
-        auto midiHandle = std::make_shared<common::midi::TwoReaderMidiHandle>();
+        auto midiHandle = std::make_shared<common::midi::MidiHandle>();
         auto midiInputStream = io::MidiInputStream(midiHandle);
         trySelectPort(midiInputStream, {"Midi Through"});
 
-        // If midi isn't available, a demo midi generator is used.
+        // If midi isn't available, a demo midi generator is used, unless a MIDI file is playing.
         auto midiGenerator = asciiboard::demo::MidiGenerator(midiHandle, asciiboard::demo::MidiGeneratorOptions{
             .noteOnTime = std::chrono::milliseconds(500),
             .noteOffTime = std::chrono::milliseconds(1000),
@@ -100,7 +192,7 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
         });
         if (midiInputStream.isOpen()) {
             midiInputStream.start();
-        } else {
+        } else if (!midiFilePath) {
             midiGenerator.start();
         }
 
@@ -120,12 +212,18 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
             .lfoGain = zeroToOne(.1),
             .delay_ms = asciiboard::Numeric<float>{180., 0., 2000.},
             .delayGain = zeroToOne(.4),
-            .filterTypeIndex = asciiboard::Numeric{0, 0, 1},
+            .filterTypeIndex = asciiboard::Numeric{0, 0, 3},
             .filterCutoffFrequency = frequency(350),
+            .filterResonance = zeroToOne(.2),
             .filterLfoDepth = asciiboard::Numeric<float>{10., 0., 1000.},
             .filterLfoFrequency = asciiboard::Numeric<float>(.25, 0, 100),
+            .reverbDecay_s = asciiboard::Numeric<float>{2., .1, 10.},
+            .reverbWet = zeroToOne(.15),
         };
-        auto asciiboard = std::make_shared<asciiboard::Asciiboard>(controls, sampleRate);
+
+        // Metering is a pass-through tap at the end of the effects chain, after the limiter.
+        auto levelMeter = std::make_shared<synth::LevelMeter>();
+        auto asciiboard = std::make_shared<asciiboard::Asciiboard>(controls, sampleRate, levelMeter);
 
         // Audio input (source)
         auto synth = std::make_shared<synth::Synthesizer>(
@@ -142,25 +240,53 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
             controls.lfoGain.value);
 
         // Effects
-        auto delay = std::make_shared<synth::Delay>(controls.getDelay_samples(sampleRate), controls.delayGain.value);
+        auto delay = std::make_shared<synth::Delay>(sampleRate, controls.getDelay_s(), controls.delayGain.value, controls.delay_ms.max / 1000);
         auto filter = std::make_shared<synth::ModulatedFilter>(
             sampleRate,
             static_cast<synth::FilterType>(controls.filterTypeIndex.value),
             controls.filterCutoffFrequency.value,
+            controls.filterResonance.value,
             controls.filterLfoDepth.value,
             controls.filterLfoFrequency.value);
+        auto fdnReverb = std::make_shared<synth::FDNReverb>(sampleRate, controls.reverbDecay_s.value, 0.4f, controls.reverbWet.value, 1.f);
+        auto effects = std::vector<std::shared_ptr<synth::I_FunctionNode>>{delay, filter, fdnReverb};
+
+        // Convolution reverb is enabled by passing an impulse response.
+        auto reverb = std::shared_ptr<synth::ConvolutionReverb>{};
+        if (impulseResponsePath) {
+            reverb = std::make_shared<synth::ConvolutionReverb>(sampleRate, synth::loadImpulseResponse(*impulseResponsePath, sampleRate), 0.3f, 1.f);
+            effects.push_back(reverb);
+        }
+
+        // The limiter keeps peaks under the ceiling, so the output stream never clips.
+        auto limiter = std::make_shared<synth::Limiter>(sampleRate);
+        M_INFO(fmt::format("Limiter latency: {:.2f} ms.", limiter->metrics().latency_ms));
+        effects.push_back(limiter);
+        effects.push_back(levelMeter);
+
+        // The oscilloscope follows the final output.
+        auto outputTap = std::make_shared<synth::Tap>();
+        effects.push_back(outputTap);
 
         // Audio output (sink)
         auto outputDevice = std::make_shared<synth::OutputDevice>(outputBufferHandle);
 
+        // A MIDI file plays through the synth, timed by the samples rendered rather than the wall clock. Live midi still
+        // gets through.
+        auto source = std::shared_ptr<synth::I_SourceNode>{synth};
+        if (midiFilePath) {
+            const auto midiFile = common::midi::readMidiFile(*midiFilePath);
+            M_INFO(fmt::format("Playing {}: type {}, {} track(s), {} events, {:.1f} s.",
+                               midiFilePath->string(),
+                               midiFile.format,
+                               midiFile.numTracks,
+                               midiFile.events.size(),
+                               midiFile.duration_s));
+            source = std::make_shared<synth::MidiFilePlayer>(synth, midiFile);
+        }
+
         // The audio pipeline of the instrument.
-        auto audioPipeline = synth::AudioPipeline{
-            synth,
-            {
-                delay,
-                filter,
-            },
-            outputDevice};
+        auto audioPipeline = synth::AudioPipeline{source, std::move(effects), outputDevice};
 
         // The thread responsible for polling the input source, applying effects, and pushing results into the output.
         // This is kept separate from the audioOutputStream, whose callback should never be blocked.
@@ -230,18 +356,36 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
             }});
         hardwareInputStream.start();
 
-        auto renderLoop = asciiboard::RenderLoop{asciiboard, midiHandle, synth};
+        auto renderLoop = asciiboard::RenderLoop{asciiboard, midiHandle, outputTap};
         renderLoop.start();
 
         auto onControlsChangedFn = [&](const asciiboard::State& newControls) {
             controls.applyChanges(*synth, newControls);
-            controls.applyChanges(*delay, newControls, sampleRate);
+            controls.applyChanges(*delay, newControls);
             controls.applyChanges(*filter, newControls);
+            controls.applyChanges(*fdnReverb, newControls);
             controls = newControls;
         };
 
-        auto onAboutToQuitFn = []() {
-            common::Log::shutdown();
+        auto onAboutToQuitFn = [&audioOutputStream, &reverb, &limiter]() {
+            if (const auto* nullBackend = dynamic_cast<const io::NullAudioBackend*>(&audioOutputStream.backend())) {
+                const auto metrics = nullBackend->metrics();
+                M_INFO(fmt::format("Null audio backend: {} callbacks, {} stalls, {} xruns, at most {:.0f} us late.",
+                                   metrics.numCallbacks,
+                                   metrics.numStalls,
+                                   metrics.numXruns,
+                                   metrics.maxLateness_us));
+            }
+            M_INFO(fmt::format("Limiter: at most {:.1f} dB of gain reduction.", limiter->metrics().maxGainReduction_dB));
+            if (reverb) {
+                const auto metrics = reverb->metrics();
+                M_INFO(fmt::format("Convolution reverb: {:.1f}% CPU for {:.2f} s of impulse response ({:.1f}% per second), {} late blocks, {} dropped tail partitions.",
+                                   100 * (metrics.headLoad + metrics.tailLoad),
+                                   metrics.impulseResponse_s,
+                                   100 * metrics.loadPerSecondOfImpulseResponse(),
+                                   metrics.numLateBlocks,
+                                   metrics.numDroppedTailPartitions));
+            }
         };
 
         // Blocks this thread
@@ -249,7 +393,12 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
 
     } catch (common::MicrotoneException& e) {
         std::cout << fmt::format("Microtone error: {}", e.what()) << std::endl;
+    } catch (std::exception& e) {
+        std::cout << fmt::format("Error: {}", e.what()) << std::endl;
     }
 
+    // On every way out, so the trace is always valid JSON. Tracing logs, so it's shut down first.
+    common::Trace::shutdown();
+    common::Log::shutdown();
     return 0;
 }
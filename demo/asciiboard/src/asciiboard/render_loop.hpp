@@ -2,7 +2,8 @@
 
 #include <asciiboard/asciiboard.hpp>
 #include <common/midi_handle.hpp>
-#include <synth/synthesizer.hpp>
+#include <common/trace.hpp>
+#include <synth/effects/tap.hpp>
 
 #include <memory>
 #include <thread>
@@ -14,15 +15,19 @@ class RenderLoop {
 public:
     RenderLoop() = delete;
     RenderLoop(std::shared_ptr<Asciiboard> ui,
-               std::shared_ptr<const common::midi::TwoReaderMidiHandle> midiHandle,
-               std::shared_ptr<const synth::Synthesizer> synthHandle) :
+               std::shared_ptr<const common::midi::MidiHandle> midiHandle,
+               std::shared_ptr<const synth::Tap> outputTap) :
         _ui(std::move(ui)),
-        _synthHandle(std::move(synthHandle)),
+        _outputTap(std::move(outputTap)),
+        _outputReader(_outputTap->subscribe()),
         _midiHandle(std::move(midiHandle)),
         _midiReaderId(_midiHandle->registerReader()) {}
 
     ~RenderLoop() {
         this->stop();
+        if (_midiReaderId) {
+            _midiHandle->unregisterReader(*_midiReaderId);
+        }
     }
 
     void start() {
@@ -38,23 +43,38 @@ public:
 
 private:
     void renderLoop() {
+        M_TRACE_THREAD("Render loop");
         while (_running) {
-            if (const auto& lastAudioBlock = _synthHandle->getLastBlock()) {
-                _ui->addOutputData(*lastAudioBlock);
-            }
-            if (!_midiReaderId) {
-                throw common::MicrotoneException("Uninitialized (no midi reader ID).");
-            }
-            if (_midiHandle->hasChanges(*_midiReaderId)) {
-                _ui->updateMidiKeyboard(_midiHandle->read(*_midiReaderId));
+            {
+                M_TRACE_ZONE("Render loop");
+                // Every block since the last frame, in order.
+                while (_outputReader.tryRead(_audioBlock)) {
+                    _ui->addOutputData(*_audioBlock);
+                }
+                _audioBlock.reset();
+                if (!_midiReaderId) {
+                    throw common::MicrotoneException("Uninitialized (no midi reader ID).");
+                }
+                auto hasMidiChanges = false;
+                auto event = common::midi::Event{};
+                while (_midiHandle->pop(*_midiReaderId, event)) {
+                    _keyboard.apply(event);
+                    hasMidiChanges = true;
+                }
+                if (hasMidiChanges) {
+                    _ui->updateMidiKeyboard(_keyboard);
+                }
             }
             std::this_thread::sleep_for(std::chrono::milliseconds(8));
         }
     }
     std::shared_ptr<Asciiboard> _ui;
-    std::shared_ptr<const synth::Synthesizer> _synthHandle;
-    std::shared_ptr<const common::midi::TwoReaderMidiHandle> _midiHandle;
+    std::shared_ptr<const synth::Tap> _outputTap;
+    synth::Tap::Reader _outputReader;
+    common::audio::SharedBlock _audioBlock{};
+    std::shared_ptr<const common::midi::MidiHandle> _midiHandle;
     std::optional<std::size_t> _midiReaderId;
+    common::midi::Keyboard _keyboard{};
 
     std::atomic<bool> _running{false};
     std::thread _thread;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <synth/effects/delay.hpp>
+#include <synth/effects/fdn_reverb.hpp>
 #include <synth/effects/modulated_filter.hpp>
 #include <synth/synthesizer.hpp>
 
@@ -120,9 +121,13 @@ struct State {
     Numeric<int> filterTypeIndex;
 
     Numeric<float> filterCutoffFrequency;
+    Numeric<float> filterResonance;
     Numeric<float> filterLfoDepth;
     Numeric<float> filterLfoFrequency;
 
+    Numeric<float> reverbDecay_s;
+    Numeric<float> reverbWet;
+
     // UI-only state
     std::shared_ptr<int> selectedTab = std::make_shared<int>(0);
     std::shared_ptr<int> selectedOscillatorControl = std::make_shared<int>(0);
@@ -142,8 +147,8 @@ struct State {
         return {attack.value, decay.value, sustain.value, release.value};
     }
 
-    [[nodiscard]] std::size_t getDelay_samples(double sampleRate) const {
-        return static_cast<std::size_t>(delay_ms.value / 1000 * sampleRate);
+    [[nodiscard]] float getDelay_s() const {
+        return delay_ms.value / 1000;
     }
 
     void resetControlSelections() {
@@ -176,9 +181,9 @@ struct State {
     }
 
     //! Applies any updated controls relevant to the Delay effect.
-    void applyChanges(synth::Delay& delay, const State& newControls, double sampleRate) const {
+    void applyChanges(synth::Delay& delay, const State& newControls) const {
         if (this->delay_ms != newControls.delay_ms) {
-            delay.setDelay(newControls.getDelay_samples(sampleRate));
+            delay.setDelay_s(newControls.getDelay_s());
         }
 
         if (this->delayGain != newControls.delayGain) {
@@ -194,6 +199,9 @@ struct State {
         if (this->filterCutoffFrequency != newControls.filterCutoffFrequency) {
             filter.setCutoffFrequencyHz(newControls.filterCutoffFrequency.value);
         }
+        if (this->filterResonance != newControls.filterResonance) {
+            filter.setResonance(newControls.filterResonance.value);
+        }
         if (this->filterLfoDepth != newControls.filterLfoDepth) {
             filter.setLFODepthHz(newControls.filterLfoDepth.value);
         }
@@ -201,6 +209,16 @@ struct State {
             filter.setLFOFrequencyHz(newControls.filterLfoFrequency.value);
         }
     }
+
+    //! Applies any updated controls relevant to the reverb.
+    void applyChanges(synth::FDNReverb& reverb, const State& newControls) const {
+        if (this->reverbDecay_s != newControls.reverbDecay_s) {
+            reverb.setDecay_s(newControls.reverbDecay_s.value);
+        }
+        if (this->reverbWet != newControls.reverbWet) {
+            reverb.setWet(newControls.reverbWet.value);
+        }
+    }
 };
 
 }
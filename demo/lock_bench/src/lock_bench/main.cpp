@@ -0,0 +1,212 @@
+#include <common/mutex_protected.hpp>
+#include <common/seq_lock_protected.hpp>
+#include <common/spin_lock.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr auto DefaultNumReaders = 3;
+constexpr auto DefaultDuration_s = 1.;
+
+//! Each thread keeps the latencies of its most recent this-many acquisitions.
+constexpr std::size_t MaxLatencySamples = 1 << 20;
+
+//! About the size of an effect's parameters: what these primitives guard in the synth.
+struct Payload {
+    std::array<float, 8> values{};
+};
+
+using Clock = std::chrono::steady_clock;
+
+//! What one thread did: how many acquisitions, and how long a sample of them waited.
+struct ThreadResult {
+    std::uint64_t numOps{0};
+    std::vector<std::uint32_t> latencies_ns;
+
+    ThreadResult() { latencies_ns.reserve(MaxLatencySamples); }
+
+    void record(Clock::duration latency) {
+        const auto latency_ns = static_cast<std::uint32_t>(std::min<std::int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count(), UINT32_MAX));
+        if (latencies_ns.size() < MaxLatencySamples) {
+            latencies_ns.push_back(latency_ns);
+        } else {
+            latencies_ns[numOps % MaxLatencySamples] = latency_ns;
+        }
+        ++numOps;
+    }
+};
+
+struct Summary {
+    double opsPerSecond{0};
+    std::uint32_t p50_ns{0};
+    std::uint32_t p99_ns{0};
+};
+
+[[nodiscard]] Summary summarize(std::vector<ThreadResult>& results, double elapsed_s) {
+    auto latencies_ns = std::vector<std::uint32_t>{};
+    auto numOps = std::uint64_t{0};
+    for (auto& result : results) {
+        latencies_ns.insert(latencies_ns.end(), result.latencies_ns.begin(), result.latencies_ns.end());
+        numOps += result.numOps;
+    }
+    if (latencies_ns.empty()) {
+        return {};
+    }
+    const auto percentile = [&latencies_ns](double p) {
+        const auto index = static_cast<std::size_t>(p * static_cast<double>(latencies_ns.size() - 1));
+        std::nth_element(latencies_ns.begin(), latencies_ns.begin() + static_cast<std::ptrdiff_t>(index), latencies_ns.end());
+        return latencies_ns[index];
+    };
+    return {static_cast<double>(numOps) / elapsed_s, percentile(0.5), percentile(0.99)};
+}
+
+//! Runs `numReaders` threads calling `read` and one calling `write`, flat out, for `duration_s`, and prints a row.
+//! Each call returns how long it waited to acquire the value, which excludes the time spent holding it.
+template <typename ReadFn, typename WriteFn>
+void run(const std::string& name, int numReaders, double duration_s, ReadFn read, WriteFn write) {
+    auto readers = std::vector<ThreadResult>(static_cast<std::size_t>(numReaders));
+    auto writers = std::vector<ThreadResult>(1);
+    auto isStarted = std::atomic<bool>{false};
+    auto isRunning = std::atomic<bool>{true};
+
+    auto threads = std::vector<std::thread>{};
+    for (auto& result : readers) {
+        threads.emplace_back([&] {
+            while (!isStarted.load(std::memory_order_acquire)) {}
+            while (isRunning.load(std::memory_order_relaxed)) {
+                result.record(read());
+            }
+        });
+    }
+    threads.emplace_back([&, &result = writers.front()] {
+        while (!isStarted.load(std::memory_order_acquire)) {}
+        for (auto i = 0u; isRunning.load(std::memory_order_relaxed); ++i) {
+            result.record(write(static_cast<float>(i)));
+        }
+    });
+
+    const auto start = Clock::now();
+    isStarted.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(duration_s));
+    isRunning.store(false, std::memory_order_relaxed);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto elapsed_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const auto reads = summarize(readers, elapsed_s);
+    const auto writes = summarize(writers, elapsed_s);
+    std::cout << fmt::format("{:<22} {:>12.3g} {:>9} {:>9} {:>12.3g} {:>9} {:>9}",
+                             name,
+                             reads.opsPerSecond,
+                             reads.p50_ns,
+                             reads.p99_ns,
+                             writes.opsPerSecond,
+                             writes.p50_ns,
+                             writes.p99_ns)
+              << std::endl;
+}
+
+//! Readers and the writer take the lock through a guard, and are timed until they hold it.
+template <typename Protected>
+void runLocked(const std::string& name, int numReaders, double duration_s) {
+    auto protectedPayload = Protected{};
+    run(
+        name,
+        numReaders,
+        duration_s,
+        [&protectedPayload] {
+            const auto start = Clock::now();
+            const auto guard = protectedPayload.lockForRead();
+            const auto latency = Clock::now() - start;
+            auto copy = *guard;
+            static_cast<void>(copy);
+            return latency;
+        },
+        [&protectedPayload](float value) {
+            const auto start = Clock::now();
+            const auto guard = protectedPayload.lockForWrite();
+            const auto latency = Clock::now() - start;
+            guard->values.fill(value);
+            return latency;
+        });
+}
+
+//! SeqLockProtected has no guards: a read is timed until it has a consistent copy, retries included.
+void runSeqLock(int numReaders, double duration_s) {
+    auto protectedPayload = common::SeqLockProtected<Payload>{};
+    run(
+        "SeqLockProtected",
+        numReaders,
+        duration_s,
+        [&protectedPayload] {
+            const auto start = Clock::now();
+            const auto copy = protectedPayload.read();
+            static_cast<void>(copy);
+            return Clock::now() - start;
+        },
+        [&protectedPayload](float value) {
+            auto payload = Payload{};
+            payload.values.fill(value);
+            const auto start = Clock::now();
+            protectedPayload.write(payload);
+            return Clock::now() - start;
+        });
+}
+
+}
+
+//! Contention benchmark for the synchronization primitives in common: N reader threads and one writer hammer a small
+//! payload for a while, and throughput and acquire latency are reported for each primitive.
+//! lock_bench [numReaders] [duration_s]
+int main(int argc, char* argv[]) {
+    auto numReaders = DefaultNumReaders;
+    auto duration_s = DefaultDuration_s;
+    try {
+        if (argc > 1) {
+            numReaders = std::stoi(argv[1]);
+        }
+        if (argc > 2) {
+            duration_s = std::stod(argv[2]);
+        }
+    } catch (const std::exception&) {
+        numReaders = 0;
+    }
+    if (numReaders < 1 || duration_s <= 0) {
+        std::cout << "Usage: lock_bench [numReaders] [duration_s]" << std::endl;
+        return 1;
+    }
+
+    std::cout << fmt::format("{} reader(s) and 1 writer, {} s each, on {} hardware thread(s). Latencies in ns.",
+                             numReaders,
+                             duration_s,
+                             std::thread::hardware_concurrency())
+              << std::endl;
+    std::cout << fmt::format("{:<22} {:>12} {:>9} {:>9} {:>12} {:>9} {:>9}",
+                             "",
+                             "reads/s",
+                             "read p50",
+                             "read p99",
+                             "writes/s",
+                             "write p50",
+                             "write p99")
+              << std::endl;
+
+    runLocked<common::MutexProtected<Payload>>("MutexProtected", numReaders, duration_s);
+    runLocked<common::SharedMutexProtected<Payload>>("SharedMutexProtected", numReaders, duration_s);
+    runLocked<common::SpinProtected<Payload>>("SpinProtected", numReaders, duration_s);
+    runSeqLock(numReaders, duration_s);
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <common/exception.hpp>
+#include <common/log.hpp>
+#include <common/midi_file.hpp>
+#include <common/midi_handle.hpp>
+
+#include <synth/midi_file_player.hpp>
+#include <synth/offline_renderer.hpp>
+#include <synth/synthesizer.hpp>
+#include <synth/wav_file_sink.hpp>
+#include <synth/wave_table.hpp>
+#include <synth/effects/convolution_reverb.hpp>
+#include <synth/effects/delay.hpp>
+#include <synth/effects/fdn_reverb.hpp>
+#include <synth/effects/limiter.hpp>
+#include <synth/effects/modulated_filter.hpp>
+
+#include <fmt/format.h>
+
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr auto Usage = "Usage: offline_render <output.wav> [duration_s] [impulse_response.wav] [performance.mid]";
+
+constexpr auto SampleRate = 48000.;
+constexpr auto DefaultDuration_s = 30.;
+
+//! How long to carry on after a MIDI file's last event, for releases and reverb tails.
+constexpr auto MidiFileTail_s = 3.;
+
+//! A positive number of seconds, or nothing if `argument` isn't one.
+[[nodiscard]] std::optional<double> parseDuration(const std::string& argument) {
+    try {
+        auto numParsed = std::size_t{0};
+        if (const auto result = std::stod(argument, &numParsed); numParsed == argument.size() && result > 0 && std::isfinite(result)) {
+            return result;
+        }
+    } catch (const std::logic_error&) {
+        // std::invalid_argument or std::out_of_range: not a duration either.
+    }
+    return std::nullopt;
+}
+
+//! Seventh chords over a I-vi-IV-V progression in C, one every two seconds, each held for a second and a half.
+[[nodiscard]] std::vector<common::midi::Event> makeScript(double duration_s) {
+    constexpr auto chords = std::array{std::array{60, 64, 67, 71},  // Cmaj7
+                                       std::array{57, 60, 64, 67},  // Am7
+                                       std::array{53, 57, 60, 64},  // Fmaj7
+                                       std::array{55, 59, 62, 65}}; // G7
+    constexpr auto chordLength_ns = std::uint64_t{2'000'000'000};
+    constexpr auto noteLength_ns = std::uint64_t{1'500'000'000};
+
+    auto result = std::vector<common::midi::Event>{};
+    const auto numChords = static_cast<std::uint64_t>(duration_s * 1e9) / chordLength_ns;
+    for (auto chord = std::uint64_t{0}; chord < numChords; ++chord) {
+        const auto& notes = chords[chord % chords.size()];
+        const auto start_ns = chord * chordLength_ns;
+        for (const auto note : notes) {
+            auto on = common::midi::Event::noteOn(note, 80);
+            on.timestamp_ns = start_ns;
+            result.push_back(on);
+        }
+        for (const auto note : notes) {
+            auto off = common::midi::Event::noteOff(note);
+            off.timestamp_ns = start_ns + noteLength_ns;
+            result.push_back(off);
+        }
+    }
+    return result;
+}
+
+}
+
+//! Renders scripted midi, or a MIDI file, through the synth and its effects into a WAV file, as fast as possible, and
+//! reports how much faster than realtime that was:
+//! offline_render <output.wav> [duration_s] [impulse_response.wav] [performance.mid]
+//! The optional arguments can come in any order: they're told apart by their extensions.
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << Usage << std::endl;
+        return 1;
+    }
+
+    common::Log::init(/* enableConsoleLogging= */ false);
+    M_INFO(fmt::format("Started logging: {}", common::Log::getDefaultLogfilePath()));
+
+    try {
+        const auto outputPath = std::string{argv[1]};
+        auto duration = std::optional<double>{};
+        auto impulseResponsePath = std::optional<std::filesystem::path>{};
+        auto midiFilePath = std::optional<std::filesystem::path>{};
+        for (auto i = 2; i < argc; ++i) {
+            const auto argument = std::filesystem::path{argv[i]};
+            if (argument.extension() == ".wav") {
+                impulseResponsePath = argument;
+            } else if (argument.extension() == ".mid" || argument.extension() == ".midi") {
+                midiFilePath = argument;
+            } else if (const auto value = parseDuration(argv[i])) {
+                duration = value;
+            } else {
+                std::cout << fmt::format("Not a duration, impulse response or MIDI file: '{}'.", argv[i]) << std::endl;
+                std::cout << Usage << std::endl;
+                common::Log::shutdown();
+                return 1;
+            }
+        }
+
+        auto synth = std::make_shared<synth::Synthesizer>(
+            SampleRate,
+            synth::TripleWaveTableT{
+                .waveTables = {
+                    synth::buildWaveTable(synth::examples::sineWaveFill),
+                    synth::buildWaveTable(synth::examples::squareWaveFill),
+                    synth::buildWaveTable(synth::examples::triangleWaveFill)},
+                .weights = {.8f, 0.f, .2f}},
+            .9f,
+            synth::ADSR{.01, .1, .8, .09},
+            .25f,
+            .1f);
+
+        auto effects = std::vector<std::shared_ptr<synth::I_FunctionNode>>{
+            std::make_shared<synth::Delay>(SampleRate, .18f, .4f, 2.f),
+            std::make_shared<synth::ModulatedFilter>(SampleRate, synth::FilterType::LowPass, 350.f, .2f, 10.f, .25f),
+            std::make_shared<synth::FDNReverb>(SampleRate, 2.f, .4f, .15f, 1.f)};
+
+        // Nothing has to keep up with a sound card here, so the convolution reverb waits for its tail, rather than
+        // dropping it.
+        auto reverb = std::shared_ptr<synth::ConvolutionReverb>{};
+        if (impulseResponsePath) {
+            reverb = std::make_shared<synth::ConvolutionReverb>(SampleRate,
+                                                                synth::loadImpulseResponse(*impulseResponsePath, SampleRate),
+                                                                .3f,
+                                                                1.f,
+                                                                synth::ConvolutionReverb::TailDeadline::Wait);
+            effects.push_back(reverb);
+        }
+        effects.push_back(std::make_shared<synth::Limiter>(SampleRate));
+
+        // A MIDI file plays itself, sample accurately, through the synth. Otherwise, the script is fed to the renderer.
+        auto source = std::shared_ptr<synth::I_SourceNode>{synth};
+        auto script = std::vector<common::midi::Event>{};
+        auto duration_s = duration.value_or(DefaultDuration_s);
+        if (midiFilePath) {
+            const auto midiFile = common::midi::readMidiFile(*midiFilePath);
+            M_INFO(fmt::format("Playing {}: type {}, {} track(s), {} events, {:.1f} s.",
+                               midiFilePath->string(),
+                               midiFile.format,
+                               midiFile.numTracks,
+                               midiFile.events.size(),
+                               midiFile.duration_s));
+            duration_s = duration.value_or(midiFile.duration_s + MidiFileTail_s);
+            source = std::make_shared<synth::MidiFilePlayer>(synth, midiFile);
+        } else {
+            script = makeScript(duration_s);
+        }
+
+        auto sink = std::make_shared<synth::WavFileSink>(outputPath, SampleRate);
+        auto renderer = synth::OfflineRenderer{synth::AudioPipeline{source, std::move(effects), sink}};
+
+        const auto statistics = renderer.render(script, duration_s);
+        sink->close();
+
+        const auto summary = fmt::format("Rendered {:.2f} s of audio in {:.3f} s ({:.1f}x realtime) to {}.",
+                                         statistics.rendered_s,
+                                         statistics.elapsed_s,
+                                         statistics.realtimeFactor(),
+                                         outputPath);
+        M_INFO(summary);
+        std::cout << summary << std::endl;
+        if (reverb) {
+            std::cout << fmt::format("Convolution reverb: {:.1f}% of realtime.", 100 * (reverb->metrics().headLoad + reverb->metrics().tailLoad)) << std::endl;
+        }
+    } catch (common::MicrotoneException& e) {
+        std::cout << fmt::format("Microtone error: {}", e.what()) << std::endl;
+        common::Log::shutdown();
+        return 1;
+    }
+
+    common::Log::shutdown();
+    return 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <io/audio_stream_configuration.hpp>
+
+#include <span>
+
+namespace io {
+
+enum class AudioStreamError {
+    NoError = 0,
+    InitializationFailed,
+    NoDevice,
+    NoDeviceInfo,
+    UnsupportedConfiguration,
+    OpenStreamError,
+    StartStreamError,
+    StopStreamError,
+};
+
+//! Fills `output` with the next samples. Backends call it from their realtime thread, at whatever size they like.
+using RenderCallback = void (*)(std::span<float> output, void* userData);
+
+//! Whatever drives the output: a sound card, or a stand-in for one. A backend owns the thread the callback runs on,
+//! and paces it at its sample rate.
+class I_AudioBackend {
+public:
+    virtual ~I_AudioBackend() = default;
+
+    //! Prepares the stream. If this fails, the backend mustn't be started.
+    [[nodiscard]] virtual AudioStreamError open(RenderCallback callback, void* userData) = 0;
+
+    virtual void start() = 0;
+    virtual void stop() = 0;
+
+    //! Valid once opened.
+    [[nodiscard]] virtual double sampleRate() const = 0;
+
+    //! What the stream was opened with, including the latency it achieved. Valid once opened.
+    [[nodiscard]] virtual AudioStreamInfo streamInfo() const = 0;
+};
+
+}
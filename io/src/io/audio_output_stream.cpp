@@ -1,93 +1,43 @@
 #include <io/audio_output_stream.hpp>
 
-#include <portaudio.h>
+#include <io/portaudio_backend.hpp>
 
 #include <common/exception.hpp>
 #include <common/log.hpp>
-#include <common/ring_buffer.hpp>
-#include <common/timer.hpp>
+#include <common/realtime_log.hpp>
+#include <common/sample_fifo.hpp>
+#include <common/trace.hpp>
+
+#include <algorithm>
 
 namespace io {
 
 class AudioOutputStream::impl {
 public:
-    explicit impl(std::shared_ptr<common::RingBuffer<common::audio::FrameBlock>> outputBuffer) :
+    impl(std::shared_ptr<common::SampleFifo> outputBuffer, std::unique_ptr<I_AudioBackend> backend) :
         _outputBuffer{std::move(outputBuffer)},
-        _portAudioStream{nullptr},
-        _sampleRate{0},
-        _createStreamError{AudioStreamError::NoError} {
+        _backend{std::move(backend)},
+        _createStreamError{_backend->open(&renderCallback, _outputBuffer.get())} {}
 
-        if (auto initResult = Pa_Initialize(); initResult != paNoError) {
-            _createStreamError = AudioStreamError::InitializationFailed;
-            return;
-        }
+    ~impl() = default;
 
-        auto deviceId = Pa_GetDefaultOutputDevice();
-        if (deviceId == paNoDevice) {
-            _createStreamError = AudioStreamError::NoDevice;
-            return;
-        }
+    //! The same for every backend.
+    static void renderCallback(std::span<float> output, void* rawUserData) {
+        common::RealtimeLog::markThreadRealtime();
+        M_TRACE_THREAD("Audio callback");
+        M_TRACE_ZONE("Callback");
 
-        const auto deviceInfo = Pa_GetDeviceInfo(deviceId);
-        if (!deviceInfo) {
-            _createStreamError = AudioStreamError::NoDeviceInfo;
+        auto* userData = static_cast<common::SampleFifo*>(rawUserData);
+        if (!userData) {
             return;
         }
-        _sampleRate = deviceInfo->defaultSampleRate;
-
-        auto outputParameters = PaStreamParameters{
-            /* device */ deviceId,
-            /* channelCount */ 1,
-            /* sampleFormat */ paFloat32,
-            /* suggestedLatency */ deviceInfo->defaultLowOutputLatency,
-            /* hostApiSpecificStreamInfo */ nullptr};
-
-        auto openStreamResult = Pa_OpenStream(
-            &_portAudioStream,
-            nullptr,
-            &outputParameters,
-            _sampleRate,
-            common::audio::AudioBlockSize,
-            paNoFlag,
-            &portAudioCallback,
-            _outputBuffer.get());
-
-        if (openStreamResult != paNoError) {
-            M_ERROR(fmt::format("ERROR: {}", static_cast<int>(openStreamResult)));
-            _createStreamError = AudioStreamError::OpenStreamError;
-        }
-    }
 
-    ~impl() {
-        if (_portAudioStream) {
-            Pa_StopStream(_portAudioStream);
+        // Levels are the pipeline's job (see synth::Limiter); this is a plain copy, straight out of the FIFO.
+        const auto numRead = userData->read(output);
+        if (numRead < output.size()) {
+            std::fill(output.begin() + numRead, output.end(), 0.f);
+            M_RT_ERROR("Underrun: {} of {} samples were ready.", numRead, output.size());
         }
-        Pa_Terminate();
-    }
-
-    static int portAudioCallback(const void* /*input*/,
-                                 void* outputBuffer,
-                                 unsigned long framesPerBuffer,
-                                 const PaStreamCallbackTimeInfo* /*timeInfo*/,
-                                 PaStreamCallbackFlags /*statusFlags*/,
-                                 void* rawUserData) {
-        auto* userData = static_cast<common::RingBuffer<common::audio::FrameBlock>*>(rawUserData);
-        auto* out = static_cast<float*>(outputBuffer);
-        if (!userData || !out) {
-            return paContinue;
-        }
-
-        auto addData = [&out](const common::audio::FrameBlock& block) {
-            for (const auto& v : block) {
-                *out++ = std::clamp<float>(v, -1., 1.);
-            }
-        };
-
-        if (!userData->pop(addData)) {
-            M_ERROR(fmt::format("Dropped frame!"));
-        }
-
-        return paContinue;
     }
 
     [[nodiscard]] AudioStreamError createStreamError() const {
@@ -95,35 +45,38 @@ public:
     }
 
     void start() {
-        if (auto startStreamResult = Pa_StartStream(_portAudioStream); startStreamResult != paNoError) {
-            throw common::MicrotoneException(fmt::format("PortAudio error: {}, '{}'.",
-                                                         startStreamResult,
-                                                         Pa_GetErrorText(startStreamResult)));
-        }
+        _backend->start();
         M_INFO("Started audio output stream.");
     }
 
     void stop() {
-        if (auto stopStreamResult = Pa_StopStream(_portAudioStream); stopStreamResult != paNoError) {
-            throw common::MicrotoneException(fmt::format("PortAudio error: {}, '{}'.",
-                                                         stopStreamResult,
-                                                         Pa_GetErrorText(stopStreamResult)));
-        }
+        _backend->stop();
         M_INFO("Stopped audio output stream.");
     }
 
     [[nodiscard]] double sampleRate() const {
-        return _sampleRate;
+        return _backend->sampleRate();
+    }
+
+    [[nodiscard]] AudioStreamInfo streamInfo() const {
+        return _backend->streamInfo();
     }
 
-    std::shared_ptr<common::RingBuffer<common::audio::FrameBlock>> _outputBuffer;
-    PaStream* _portAudioStream;
-    double _sampleRate;
+    [[nodiscard]] const I_AudioBackend& backend() const {
+        return *_backend;
+    }
+
+    std::shared_ptr<common::SampleFifo> _outputBuffer;
+    std::unique_ptr<I_AudioBackend> _backend;
     AudioStreamError _createStreamError;
 };
 
-AudioOutputStream::AudioOutputStream(std::shared_ptr<common::RingBuffer<common::audio::FrameBlock>> inputBuffer) :
-    _impl{std::make_unique<impl>(inputBuffer)} {
+AudioOutputStream::AudioOutputStream(std::shared_ptr<common::SampleFifo> inputBuffer) :
+    AudioOutputStream(std::move(inputBuffer), std::make_unique<PortAudioBackend>()) {
+}
+
+AudioOutputStream::AudioOutputStream(std::shared_ptr<common::SampleFifo> inputBuffer, std::unique_ptr<I_AudioBackend> backend) :
+    _impl{std::make_unique<impl>(std::move(inputBuffer), std::move(backend))} {
 }
 
 AudioOutputStream::AudioOutputStream(AudioOutputStream&& other) noexcept :
@@ -164,4 +117,15 @@ double AudioOutputStream::sampleRate() const {
     return _impl->sampleRate();
 }
 
+AudioStreamInfo AudioOutputStream::streamInfo() const {
+    if (this->createStreamError() != AudioStreamError::NoError) {
+        throw common::MicrotoneException("Audio output stream initialization failed.");
+    }
+    return _impl->streamInfo();
+}
+
+const I_AudioBackend& AudioOutputStream::backend() const {
+    return _impl->backend();
+}
+
 }
@@ -1,25 +1,19 @@
 #pragma once
 
-#include <common/ring_buffer.hpp>
+#include <common/sample_fifo.hpp>
+#include <io/audio_backend.hpp>
 
 #include <memory>
 
 namespace io {
 
-enum class AudioStreamError {
-    NoError = 0,
-    InitializationFailed,
-    NoDevice,
-    NoDeviceInfo,
-    OpenStreamError,
-    StartStreamError,
-    StopStreamError,
-};
-
-//! This is the portaudio wrapper.
+//! Plays `inputBuffer` through an audio backend. The backend picks its own callback size, which needn't match the
+//! pipeline's block size: the callback reads however many samples it's asked for from `inputBuffer`.
 class AudioOutputStream {
 public:
-    explicit AudioOutputStream(std::shared_ptr<common::RingBuffer<common::audio::FrameBlock>> inputBuffer);
+    //! Plays through the default PortAudio device.
+    explicit AudioOutputStream(std::shared_ptr<common::SampleFifo> inputBuffer);
+    AudioOutputStream(std::shared_ptr<common::SampleFifo> inputBuffer, std::unique_ptr<I_AudioBackend> backend);
     AudioOutputStream(const AudioOutputStream&) = delete;
     AudioOutputStream& operator=(const AudioOutputStream&) = delete;
     AudioOutputStream(AudioOutputStream&&) noexcept;
@@ -35,6 +29,13 @@ public:
 
     [[nodiscard]] double sampleRate() const;
 
+    //! The device, format and latency the stream actually got.
+    [[nodiscard]] AudioStreamInfo streamInfo() const;
+
+    //! The backend the stream plays through, for anything specific to it (a NullAudioBackend's metrics, say). Valid for
+    //! as long as the stream.
+    [[nodiscard]] const I_AudioBackend& backend() const;
+
 private:
     class impl;
     std::unique_ptr<impl> _impl;
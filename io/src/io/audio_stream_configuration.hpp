@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace io {
+
+//! What the device is fed. The pipeline always renders float; other formats are converted in the callback.
+enum class SampleFormat {
+    Float32 = 0,
+    Int32,
+    Int24, //< Packed, three bytes per sample.
+    Int16
+};
+
+[[nodiscard]] inline std::size_t bytesPerSample(SampleFormat format) {
+    switch (format) {
+    case SampleFormat::Int24:
+        return 3;
+    case SampleFormat::Int16:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+[[nodiscard]] inline const char* toString(SampleFormat format) {
+    switch (format) {
+    case SampleFormat::Int32:
+        return "int32";
+    case SampleFormat::Int24:
+        return "int24";
+    case SampleFormat::Int16:
+        return "int16";
+    default:
+        return "float32";
+    }
+}
+
+//! How to open an output stream. Anything left unset falls back to the device's defaults.
+struct AudioStreamConfiguration {
+    std::optional<std::string> hostApi;       //< e.g. "ALSA" or "JACK Audio Connection Kit". The default host API if unset.
+    std::optional<std::string> device;        //< All or part of a device name, e.g. "hw:0,0". The host API's default output if unset.
+    int numChannels{1};                       //< The (mono) signal is copied to every channel.
+    SampleFormat sampleFormat{SampleFormat::Float32};
+    bool dither{true};                        //< TPDF dither before rounding to 16 or 24 bits.
+    std::optional<double> sampleRate;         //< The device's default rate if unset.
+    std::size_t framesPerBuffer{0};           //< 0 lets the device choose, and vary it from callback to callback.
+    std::optional<double> suggestedLatency_s; //< The device's default low latency if unset.
+};
+
+//! An output device, as listed by `PortAudioBackend::outputDevices`.
+struct AudioDeviceInfo {
+    int index{0};
+    std::string name;
+    std::string hostApi;
+    int maxOutputChannels{0};
+    double defaultSampleRate{0};
+    double defaultLowOutputLatency_s{0};
+    double defaultHighOutputLatency_s{0};
+    bool isDefaultOutput{false}; //< For its host API.
+};
+
+//! What a stream actually got, which may differ from what it asked for.
+struct AudioStreamInfo {
+    std::string device;
+    std::string hostApi;
+    int numChannels{1};
+    SampleFormat sampleFormat{SampleFormat::Float32};
+    double sampleRate{0};
+    std::size_t framesPerBuffer{0}; //< 0 if the device chooses.
+    double outputLatency_s{0};
+};
+
+}
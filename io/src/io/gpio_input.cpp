@@ -9,6 +9,7 @@
 
 #include "common/exception.hpp"
 #include "common/log.hpp"
+#include "common/trace.hpp"
 
 namespace io {
 
@@ -101,8 +102,10 @@ public:
 
 private:
     void processLoop() {
+        M_TRACE_THREAD("Gpio");
         while (_running) {
             if (_gpioManager.lineRequest.wait_edge_events(std::chrono::seconds(1))) {
+                M_TRACE_ZONE("Gpio events");
                 _gpioManager.lineRequest.read_edge_events(_eventBuffer);
 
                 for (const auto& edgeEvent : _eventBuffer) {
@@ -2,6 +2,7 @@
 
 #include <common/exception.hpp>
 #include <common/log.hpp>
+#include <common/trace.hpp>
 #include <io/midi_message.hpp>
 
 #include <RtMidi.h>
@@ -13,11 +14,12 @@
 namespace io {
 
 namespace {
-void addMidiData(common::midi::TwoReaderMidiHandle& handle, const MidiMessage& m) {
+void addMidiData(common::midi::MidiHandle& handle, const MidiMessage& m) {
     const auto status = static_cast<MidiStatusMessage>(m.status);
-    if (status == MidiStatusMessage::NoteOn) {
+    if (status == MidiStatusMessage::NoteOn && m.velocity > 0) {
         handle.noteOn(m.note, m.velocity);
-    } else if (status == MidiStatusMessage::NoteOff) {
+    } else if (status == MidiStatusMessage::NoteOn || status == MidiStatusMessage::NoteOff) {
+        // A note on with zero velocity is a note off.
         handle.noteOff(m.note);
     } else if (status == MidiStatusMessage::ControlChange) {
         const auto midiNoteMessage = static_cast<MidiNoteMessage>(m.note);
@@ -27,6 +29,8 @@ void addMidiData(common::midi::TwoReaderMidiHandle& handle, const MidiMessage& m
             } else {
                 handle.sustainOff();
             }
+        } else {
+            handle.controlChange(m.note, m.velocity);
         }
     }
 }
@@ -34,7 +38,7 @@ void addMidiData(common::midi::TwoReaderMidiHandle& handle, const MidiMessage& m
 
 class MidiInputStream::impl {
 public:
-    explicit impl(std::shared_ptr<common::midi::TwoReaderMidiHandle> midiHandle) :
+    explicit impl(std::shared_ptr<common::midi::MidiHandle> midiHandle) :
         _midiHandle(std::move(midiHandle)),
         _rtMidiConnection{std::make_unique<RtMidiIn>()} {
         // Don't ignore sysex, timing, or active sensing messages.
@@ -94,6 +98,8 @@ private:
         std::vector<unsigned char>* message,
         void* userData
     ) {
+        M_TRACE_THREAD("Midi");
+        M_TRACE_ZONE("Midi callback");
         auto* self = static_cast<impl*>(userData);
 
         if (!self->_isRunning.load(std::memory_order_relaxed)) {
@@ -113,12 +119,12 @@ private:
             MidiMessage{status, note, velocity});
     }
 
-    std::shared_ptr<common::midi::TwoReaderMidiHandle> _midiHandle;
+    std::shared_ptr<common::midi::MidiHandle> _midiHandle;
     std::unique_ptr<RtMidiIn> _rtMidiConnection;
     std::atomic<bool> _isRunning{false};
 };
 
-MidiInputStream::MidiInputStream(std::shared_ptr<common::midi::TwoReaderMidiHandle> stateHandle) :
+MidiInputStream::MidiInputStream(std::shared_ptr<common::midi::MidiHandle> stateHandle) :
     _impl{std::make_unique<impl>(stateHandle)} {
 }
 
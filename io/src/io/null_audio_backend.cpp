@@ -0,0 +1,168 @@
+#include <io/null_audio_backend.hpp>
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace io {
+
+class NullAudioBackend::impl {
+    using Clock = std::chrono::steady_clock;
+
+public:
+    explicit impl(const Options& options) :
+        _options{options},
+        _buffer(options.framesPerBuffer, 0.f),
+        _random{options.seed} {}
+
+    ~impl() {
+        stop();
+    }
+
+    [[nodiscard]] AudioStreamError open(RenderCallback callback, void* userData) {
+        if (!callback || _options.sampleRate <= 0 || _options.framesPerBuffer == 0) {
+            return AudioStreamError::OpenStreamError;
+        }
+        _callback = callback;
+        _userData = userData;
+        return AudioStreamError::NoError;
+    }
+
+    void start() {
+        if (_running.exchange(true)) {
+            return;
+        }
+        _thread = std::thread(&impl::timerLoop, this);
+    }
+
+    void stop() {
+        _running = false;
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    [[nodiscard]] double sampleRate() const {
+        return _options.sampleRate;
+    }
+
+    [[nodiscard]] AudioStreamInfo streamInfo() const {
+        return {
+            .device = "null",
+            .hostApi = "none",
+            .numChannels = 1,
+            .sampleFormat = SampleFormat::Float32,
+            .sampleRate = _options.sampleRate,
+            .framesPerBuffer = _options.framesPerBuffer,
+            .outputLatency_s = static_cast<double>(_options.framesPerBuffer) / _options.sampleRate};
+    }
+
+    [[nodiscard]] Metrics metrics() const {
+        return {
+            .numCallbacks = _numCallbacks.load(std::memory_order_relaxed),
+            .numStalls = _numStalls.load(std::memory_order_relaxed),
+            .numXruns = _numXruns.load(std::memory_order_relaxed),
+            .maxLateness_us = _maxLateness_us.load(std::memory_order_relaxed)};
+    }
+
+private:
+    //! When buffer `index` is due. Computed from the start, not the previous buffer, so the clock doesn't drift.
+    [[nodiscard]] Clock::time_point deadline(Clock::time_point start, std::uint64_t index) const {
+        const auto elapsed_s = static_cast<double>(index * _options.framesPerBuffer) / _options.sampleRate;
+        return start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(elapsed_s));
+    }
+
+    //! How late to make the next callback, on purpose.
+    [[nodiscard]] Clock::duration injectedDelay() {
+        auto result = Clock::duration::zero();
+        if (_options.maxJitter.count() > 0) {
+            auto jitter = std::uniform_int_distribution<std::int64_t>(0, _options.maxJitter.count());
+            result += std::chrono::microseconds(jitter(_random));
+        }
+        if (_options.stallProbability > 0 && std::bernoulli_distribution(_options.stallProbability)(_random)) {
+            _numStalls.fetch_add(1, std::memory_order_relaxed);
+            result += _options.stallDuration;
+        }
+        return result;
+    }
+
+    void timerLoop() {
+        const auto bufferDuration = deadline({}, 1) - Clock::time_point{};
+        const auto start = Clock::now();
+        auto index = std::uint64_t{0};
+
+        while (_running.load(std::memory_order_relaxed)) {
+            const auto due = deadline(start, index);
+            std::this_thread::sleep_until(due + injectedDelay());
+
+            const auto lateness = Clock::now() - due;
+            const auto lateness_us = std::chrono::duration<double, std::micro>(lateness).count();
+            if (lateness_us > _maxLateness_us.load(std::memory_order_relaxed)) {
+                _maxLateness_us.store(lateness_us, std::memory_order_relaxed);
+            }
+
+            _callback(_buffer, _userData);
+            _numCallbacks.fetch_add(1, std::memory_order_relaxed);
+            ++index;
+
+            // A device wouldn't wait for us: skip the buffers that went by while this one was late.
+            if (lateness > bufferDuration) {
+                _numXruns.fetch_add(1, std::memory_order_relaxed);
+                index += static_cast<std::uint64_t>(lateness / bufferDuration);
+            }
+        }
+    }
+
+    Options _options;
+    RenderCallback _callback{nullptr};
+    void* _userData{nullptr};
+
+    // Timer thread only.
+    std::vector<float> _buffer;
+    std::minstd_rand _random;
+
+    std::atomic<std::uint64_t> _numCallbacks{0};
+    std::atomic<std::uint64_t> _numStalls{0};
+    std::atomic<std::uint64_t> _numXruns{0};
+    std::atomic<double> _maxLateness_us{0};
+
+    std::atomic<bool> _running{false};
+    std::thread _thread;
+};
+
+NullAudioBackend::NullAudioBackend() :
+    NullAudioBackend(Options{}) {
+}
+
+NullAudioBackend::NullAudioBackend(const Options& options) :
+    _impl{std::make_unique<impl>(options)} {
+}
+
+NullAudioBackend::~NullAudioBackend() = default;
+
+AudioStreamError NullAudioBackend::open(RenderCallback callback, void* userData) {
+    return _impl->open(callback, userData);
+}
+
+void NullAudioBackend::start() {
+    _impl->start();
+}
+
+void NullAudioBackend::stop() {
+    _impl->stop();
+}
+
+double NullAudioBackend::sampleRate() const {
+    return _impl->sampleRate();
+}
+
+AudioStreamInfo NullAudioBackend::streamInfo() const {
+    return _impl->streamInfo();
+}
+
+NullAudioBackend::Metrics NullAudioBackend::metrics() const {
+    return _impl->metrics();
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <io/audio_backend.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace io {
+
+//! A stand-in for a sound card, so the realtime path (instrument thread, FIFO, callback) can run and be load-tested on
+//! machines without audio hardware. A timer thread calls the callback every `framesPerBuffer` samples of a virtual
+//! clock at `sampleRate`, and throws the samples away.
+//! Callbacks can be made late on purpose: by up to `maxJitter` each, and now and then by a whole `stallDuration`. A
+//! callback that's later than one buffer is an xrun: a real device would have run dry, so, like one, the clock carries
+//! on without it and the buffers it missed are skipped.
+class NullAudioBackend : public I_AudioBackend {
+public:
+    struct Options {
+        double sampleRate{48000};
+        std::size_t framesPerBuffer{256};
+        std::chrono::microseconds maxJitter{0};
+        double stallProbability{0}; //< Per callback.
+        std::chrono::microseconds stallDuration{0};
+        std::uint32_t seed{1}; //< For the jitter and stalls, so a run can be repeated.
+    };
+
+    struct Metrics {
+        std::uint64_t numCallbacks{0};
+        std::uint64_t numStalls{0};
+        std::uint64_t numXruns{0};
+        double maxLateness_us{0}; //< The furthest a callback started behind the virtual clock.
+    };
+
+    NullAudioBackend();
+    explicit NullAudioBackend(const Options& options);
+    NullAudioBackend(const NullAudioBackend&) = delete;
+    NullAudioBackend& operator=(const NullAudioBackend&) = delete;
+    ~NullAudioBackend() override;
+
+    [[nodiscard]] AudioStreamError open(RenderCallback callback, void* userData) override;
+    void start() override;
+    void stop() override;
+    [[nodiscard]] double sampleRate() const override;
+
+    //! One buffer of latency: it has nothing else to add.
+    [[nodiscard]] AudioStreamInfo streamInfo() const override;
+
+    //! Safe to call from any thread while running.
+    [[nodiscard]] Metrics metrics() const;
+
+private:
+    class impl;
+    std::unique_ptr<impl> _impl;
+};
+
+}
@@ -0,0 +1,313 @@
+#include <io/portaudio_backend.hpp>
+#include <io/sample_converter.hpp>
+
+#include <portaudio.h>
+
+#include <common/exception.hpp>
+#include <common/log.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace io {
+
+namespace {
+
+//! Frames rendered per pass when the device's buffer needs converting. Devices may ask for more; that just takes
+//! several passes.
+constexpr std::size_t MaxFramesPerPass = 1024;
+
+[[nodiscard]] PaSampleFormat toPortAudio(SampleFormat format) {
+    switch (format) {
+    case SampleFormat::Int32:
+        return paInt32;
+    case SampleFormat::Int24:
+        return paInt24;
+    case SampleFormat::Int16:
+        return paInt16;
+    default:
+        return paFloat32;
+    }
+}
+
+//! Initializes PortAudio for as long as it lives. PortAudio counts these, so they can overlap.
+class PortAudioSession {
+public:
+    PortAudioSession() :
+        _error{Pa_Initialize()} {}
+
+    ~PortAudioSession() {
+        if (_error == paNoError) {
+            Pa_Terminate();
+        }
+    }
+
+    PortAudioSession(const PortAudioSession&) = delete;
+    PortAudioSession& operator=(const PortAudioSession&) = delete;
+
+    [[nodiscard]] bool isInitialized() const { return _error == paNoError; }
+
+private:
+    PaError _error;
+};
+
+[[nodiscard]] AudioDeviceInfo describeDevice(PaDeviceIndex index, const PaDeviceInfo& info) {
+    const auto* hostApi = Pa_GetHostApiInfo(info.hostApi);
+    return {
+        .index = index,
+        .name = info.name ? info.name : "",
+        .hostApi = hostApi && hostApi->name ? hostApi->name : "",
+        .maxOutputChannels = info.maxOutputChannels,
+        .defaultSampleRate = info.defaultSampleRate,
+        .defaultLowOutputLatency_s = info.defaultLowOutputLatency,
+        .defaultHighOutputLatency_s = info.defaultHighOutputLatency,
+        .isDefaultOutput = hostApi && hostApi->defaultOutputDevice == index};
+}
+
+//! The host API whose name contains `name`, or the default one.
+[[nodiscard]] std::optional<PaHostApiIndex> findHostApi(const std::optional<std::string>& name) {
+    if (!name) {
+        const auto index = Pa_GetDefaultHostApi();
+        return index >= 0 ? std::optional{index} : std::nullopt;
+    }
+    for (auto index = PaHostApiIndex{0}; index < Pa_GetHostApiCount(); ++index) {
+        const auto* info = Pa_GetHostApiInfo(index);
+        if (info && info->name && std::string_view{info->name}.find(*name) != std::string_view::npos) {
+            return index;
+        }
+    }
+    return std::nullopt;
+}
+
+//! The output device on `hostApi` whose name contains `name`, or that host API's default output.
+[[nodiscard]] PaDeviceIndex findDevice(PaHostApiIndex hostApi, const std::optional<std::string>& name) {
+    const auto* hostApiInfo = Pa_GetHostApiInfo(hostApi);
+    if (!hostApiInfo) {
+        return paNoDevice;
+    }
+    if (!name) {
+        return hostApiInfo->defaultOutputDevice;
+    }
+    for (auto i = 0; i < hostApiInfo->deviceCount; ++i) {
+        const auto index = Pa_HostApiDeviceIndexToDeviceIndex(hostApi, i);
+        const auto* info = Pa_GetDeviceInfo(index);
+        if (info && info->maxOutputChannels > 0 && info->name && std::string_view{info->name}.find(*name) != std::string_view::npos) {
+            return index;
+        }
+    }
+    return paNoDevice;
+}
+
+}
+
+class PortAudioBackend::impl {
+public:
+    explicit impl(const AudioStreamConfiguration& configuration) :
+        _configuration{configuration},
+        _scratch(MaxFramesPerPass, 0.f),
+        _converter{configuration.sampleFormat, configuration.numChannels, configuration.dither} {}
+
+    ~impl() {
+        if (_portAudioStream) {
+            Pa_StopStream(_portAudioStream);
+            Pa_CloseStream(_portAudioStream);
+        }
+    }
+
+    [[nodiscard]] AudioStreamError open(RenderCallback callback, void* userData) {
+        _callback = callback;
+        _userData = userData;
+
+        if (!_session.isInitialized()) {
+            return AudioStreamError::InitializationFailed;
+        }
+
+        const auto hostApi = findHostApi(_configuration.hostApi);
+        if (!hostApi) {
+            M_ERROR(fmt::format("No host API matches '{}'.", _configuration.hostApi.value_or("")));
+            return AudioStreamError::NoDevice;
+        }
+        const auto deviceId = findDevice(*hostApi, _configuration.device);
+        if (deviceId == paNoDevice) {
+            if (_configuration.device) {
+                M_ERROR(fmt::format("No output device matches '{}'.", *_configuration.device));
+            }
+            return AudioStreamError::NoDevice;
+        }
+
+        const auto deviceInfo = Pa_GetDeviceInfo(deviceId);
+        if (!deviceInfo) {
+            return AudioStreamError::NoDeviceInfo;
+        }
+        _info = AudioStreamInfo{
+            .device = deviceInfo->name ? deviceInfo->name : "",
+            .hostApi = describeDevice(deviceId, *deviceInfo).hostApi,
+            .numChannels = _configuration.numChannels,
+            .sampleFormat = _configuration.sampleFormat,
+            .sampleRate = _configuration.sampleRate.value_or(deviceInfo->defaultSampleRate),
+            .framesPerBuffer = _configuration.framesPerBuffer};
+
+        auto outputParameters = PaStreamParameters{
+            /* device */ deviceId,
+            /* channelCount */ _configuration.numChannels,
+            /* sampleFormat */ toPortAudio(_configuration.sampleFormat),
+            /* suggestedLatency */ _configuration.suggestedLatency_s.value_or(deviceInfo->defaultLowOutputLatency),
+            /* hostApiSpecificStreamInfo */ nullptr};
+
+        if (Pa_IsFormatSupported(nullptr, &outputParameters, _info.sampleRate) != paFormatIsSupported) {
+            M_ERROR(fmt::format("{} ({}) doesn't support {} channel(s) of {} at {} Hz.",
+                                _info.device,
+                                _info.hostApi,
+                                _info.numChannels,
+                                toString(_info.sampleFormat),
+                                _info.sampleRate));
+            return AudioStreamError::UnsupportedConfiguration;
+        }
+
+        auto openStreamResult = Pa_OpenStream(
+            &_portAudioStream,
+            nullptr,
+            &outputParameters,
+            _info.sampleRate,
+            _configuration.framesPerBuffer == 0 ? paFramesPerBufferUnspecified : _configuration.framesPerBuffer,
+            paNoFlag,
+            &portAudioCallback,
+            this);
+
+        if (openStreamResult != paNoError) {
+            M_ERROR(fmt::format("ERROR: {}", static_cast<int>(openStreamResult)));
+            _portAudioStream = nullptr;
+            return AudioStreamError::OpenStreamError;
+        }
+
+        if (const auto* streamInfo = Pa_GetStreamInfo(_portAudioStream)) {
+            _info.sampleRate = streamInfo->sampleRate;
+            _info.outputLatency_s = streamInfo->outputLatency;
+        }
+        M_INFO(fmt::format("Opened {} ({}): {} channel(s) of {} at {} Hz, {} frames per buffer, {:.2f} ms output latency.",
+                           _info.device,
+                           _info.hostApi,
+                           _info.numChannels,
+                           toString(_info.sampleFormat),
+                           _info.sampleRate,
+                           _info.framesPerBuffer == 0 ? std::string{"variable"} : std::to_string(_info.framesPerBuffer),
+                           1000 * _info.outputLatency_s));
+        return AudioStreamError::NoError;
+    }
+
+    static int portAudioCallback(const void* /*input*/,
+                                 void* outputBuffer,
+                                 unsigned long framesPerBuffer,
+                                 const PaStreamCallbackTimeInfo* /*timeInfo*/,
+                                 PaStreamCallbackFlags /*statusFlags*/,
+                                 void* rawUserData) {
+        auto* self = static_cast<impl*>(rawUserData);
+        if (self && outputBuffer) {
+            self->render(outputBuffer, framesPerBuffer);
+        }
+        return paContinue;
+    }
+
+    void start() {
+        if (auto startStreamResult = Pa_StartStream(_portAudioStream); startStreamResult != paNoError) {
+            throw common::MicrotoneException(fmt::format("PortAudio error: {}, '{}'.",
+                                                         startStreamResult,
+                                                         Pa_GetErrorText(startStreamResult)));
+        }
+    }
+
+    void stop() {
+        if (auto stopStreamResult = Pa_StopStream(_portAudioStream); stopStreamResult != paNoError) {
+            throw common::MicrotoneException(fmt::format("PortAudio error: {}, '{}'.",
+                                                         stopStreamResult,
+                                                         Pa_GetErrorText(stopStreamResult)));
+        }
+    }
+
+    [[nodiscard]] double sampleRate() const {
+        return _info.sampleRate;
+    }
+
+    [[nodiscard]] AudioStreamInfo streamInfo() const {
+        return _info;
+    }
+
+private:
+    void render(void* outputBuffer, std::size_t numFrames) {
+        // Mono float is what the callback renders, so it can write straight into the device's buffer.
+        if (_info.sampleFormat == SampleFormat::Float32 && _info.numChannels == 1) {
+            _callback({static_cast<float*>(outputBuffer), numFrames}, _userData);
+            return;
+        }
+
+        auto* out = static_cast<unsigned char*>(outputBuffer);
+        const auto frameSize = bytesPerSample(_info.sampleFormat) * static_cast<std::size_t>(_info.numChannels);
+        for (auto offset = std::size_t{0}; offset < numFrames;) {
+            const auto count = std::min(numFrames - offset, _scratch.size());
+            const auto mono = std::span{_scratch}.first(count);
+            _callback(mono, _userData);
+            _converter.convert(mono, out + offset * frameSize);
+            offset += count;
+        }
+    }
+
+    PortAudioSession _session;
+    AudioStreamConfiguration _configuration;
+    AudioStreamInfo _info;
+    RenderCallback _callback{nullptr};
+    void* _userData{nullptr};
+    PaStream* _portAudioStream{nullptr};
+
+    // Callback only.
+    std::vector<float> _scratch;
+    SampleConverter _converter;
+};
+
+PortAudioBackend::PortAudioBackend() :
+    PortAudioBackend(AudioStreamConfiguration{}) {
+}
+
+PortAudioBackend::PortAudioBackend(const AudioStreamConfiguration& configuration) :
+    _impl{std::make_unique<impl>(configuration)} {
+}
+
+PortAudioBackend::~PortAudioBackend() = default;
+
+std::vector<AudioDeviceInfo> PortAudioBackend::outputDevices() {
+    const auto session = PortAudioSession{};
+    if (!session.isInitialized()) {
+        return {};
+    }
+
+    auto result = std::vector<AudioDeviceInfo>{};
+    for (auto index = PaDeviceIndex{0}; index < Pa_GetDeviceCount(); ++index) {
+        if (const auto* info = Pa_GetDeviceInfo(index); info && info->maxOutputChannels > 0) {
+            result.push_back(describeDevice(index, *info));
+        }
+    }
+    return result;
+}
+
+AudioStreamError PortAudioBackend::open(RenderCallback callback, void* userData) {
+    return _impl->open(callback, userData);
+}
+
+void PortAudioBackend::start() {
+    _impl->start();
+}
+
+void PortAudioBackend::stop() {
+    _impl->stop();
+}
+
+double PortAudioBackend::sampleRate() const {
+    return _impl->sampleRate();
+}
+
+AudioStreamInfo PortAudioBackend::streamInfo() const {
+    return _impl->streamInfo();
+}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <io/audio_backend.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace io {
+
+//! Output through PortAudio. By default, mono float on the default device, at its default rate and low latency, with
+//! the device picking its own callback size; `AudioStreamConfiguration` overrides any of that.
+class PortAudioBackend : public I_AudioBackend {
+public:
+    PortAudioBackend();
+    explicit PortAudioBackend(const AudioStreamConfiguration& configuration);
+    PortAudioBackend(const PortAudioBackend&) = delete;
+    PortAudioBackend& operator=(const PortAudioBackend&) = delete;
+    ~PortAudioBackend() override;
+
+    //! Every device with at least one output channel, on every host API.
+    [[nodiscard]] static std::vector<AudioDeviceInfo> outputDevices();
+
+    [[nodiscard]] AudioStreamError open(RenderCallback callback, void* userData) override;
+    void start() override;
+    void stop() override;
+    [[nodiscard]] double sampleRate() const override;
+
+    //! The latency comes from `Pa_GetStreamInfo`: what the host API granted, not what was suggested.
+    [[nodiscard]] AudioStreamInfo streamInfo() const override;
+
+private:
+    class impl;
+    std::unique_ptr<impl> _impl;
+};
+
+}
@@ -0,0 +1,146 @@
+#include <io/sample_converter.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+namespace io {
+
+namespace {
+
+using common::simd::Float4;
+using common::simd::Int4;
+using common::simd::Width;
+
+//! The sample that +1.f becomes.
+[[nodiscard]] float fullScale(SampleFormat format) {
+    switch (format) {
+    case SampleFormat::Int32:
+        // Float can't represent 2^31 - 1; 2^31 - 128 is the largest value below it that it can.
+        return 2147483520.f;
+    case SampleFormat::Int24:
+        return 8388607.f;
+    case SampleFormat::Int16:
+        return 32767.f;
+    default:
+        return 1.f;
+    }
+}
+
+//! Distinct, non-zero xorshift states for each lane, however alike the seeds.
+[[nodiscard]] Int4 seedLanes(std::uint32_t seed) {
+    auto lanes = std::array<std::int32_t, Width>{};
+    for (auto i = std::size_t{0}; i < Width; ++i) {
+        auto x = seed + static_cast<std::uint32_t>(i + 1) * 0x9e3779b9u;
+        x = (x ^ (x >> 16)) * 0x85ebca6bu;
+        x = (x ^ (x >> 13)) * 0xc2b2ae35u;
+        x ^= x >> 16;
+        lanes[i] = static_cast<std::int32_t>(x == 0 ? 1 : x);
+    }
+    return Int4::fromLanes(lanes[0], lanes[1], lanes[2], lanes[3]);
+}
+
+//! Writes the first `count` of `lanes` to every channel of consecutive frames.
+template <typename T>
+void fanOut(const std::array<T, Width>& lanes, std::size_t count, int numChannels, unsigned char* out) {
+    for (auto i = std::size_t{0}; i < count; ++i) {
+        for (auto channel = 0; channel < numChannels; ++channel, out += sizeof(T)) {
+            std::memcpy(out, &lanes[i], sizeof(T));
+        }
+    }
+}
+
+//! PortAudio's packed 24 bit samples are in native byte order.
+void fanOutInt24(const std::array<std::int32_t, Width>& lanes, std::size_t count, int numChannels, unsigned char* out) {
+    constexpr auto offset = std::endian::native == std::endian::little ? 0 : 1;
+    for (auto i = std::size_t{0}; i < count; ++i) {
+        auto bytes = std::array<unsigned char, 4>{};
+        std::memcpy(bytes.data(), &lanes[i], sizeof(lanes[i]));
+        for (auto channel = 0; channel < numChannels; ++channel, out += 3) {
+            std::memcpy(out, bytes.data() + offset, 3);
+        }
+    }
+}
+
+}
+
+SampleConverter::SampleConverter(SampleFormat format, int numChannels, bool dither, std::uint32_t seed) :
+    _format{format},
+    _numChannels{numChannels},
+    _frameSize{bytesPerSample(format) * static_cast<std::size_t>(numChannels)},
+    _fullScale{fullScale(format)},
+    _dither{dither && (format == SampleFormat::Int16 || format == SampleFormat::Int24)},
+    _state{seedLanes(seed)} {
+}
+
+void SampleConverter::convert(std::span<const float> mono, void* out) {
+    auto* frames = static_cast<unsigned char*>(out);
+    auto i = std::size_t{0};
+    for (; i + Width <= mono.size(); i += Width) {
+        convert(Float4::load(mono.data() + i), frames + i * _frameSize, Width);
+    }
+    if (const auto remaining = mono.size() - i; remaining > 0) {
+        auto tail = std::array<float, Width>{};
+        std::copy_n(mono.data() + i, remaining, tail.data());
+        convert(Float4::load(tail.data()), frames + i * _frameSize, remaining);
+    }
+}
+
+void SampleConverter::convert(Float4 samples, unsigned char* out, std::size_t count) {
+    // Mono and a whole vector: the lanes are consecutive samples, so they can be stored as they are.
+    const auto isContiguous = _numChannels == 1 && count == Width;
+
+    if (_format == SampleFormat::Float32) {
+        fanOut(samples.lanes(), count, _numChannels, out);
+        return;
+    }
+
+    const auto limit = Float4::broadcast(_fullScale);
+    auto scaled = min(max(samples, Float4::broadcast(-1.f)), Float4::broadcast(1.f)) * limit;
+    if (_dither) {
+        // Dither can push a full scale sample one step past it. Below, -fullScale - 1 is still in range.
+        scaled = min(scaled + nextDither(), limit);
+    }
+    const auto values = Int4::round(scaled);
+
+    switch (_format) {
+    case SampleFormat::Int16:
+        if (isContiguous) {
+            values.storeInt16(reinterpret_cast<std::int16_t*>(out));
+        } else {
+            auto lanes = std::array<std::int16_t, Width>{};
+            values.storeInt16(lanes.data());
+            fanOut(lanes, count, _numChannels, out);
+        }
+        break;
+    case SampleFormat::Int24:
+        fanOutInt24(values.lanes(), count, _numChannels, out);
+        break;
+    default:
+        if (isContiguous) {
+            values.store(reinterpret_cast<std::int32_t*>(out));
+        } else {
+            fanOut(values.lanes(), count, _numChannels, out);
+        }
+        break;
+    }
+}
+
+Float4 SampleConverter::nextDither() {
+    // Each random lane, as a signed integer scaled by 2^-32, is uniform over ±½.
+    const auto a = nextRandom().toFloat();
+    const auto b = nextRandom().toFloat();
+    return (a + b) * Float4::broadcast(0x1p-32f);
+}
+
+Int4 SampleConverter::nextRandom() {
+    auto x = _state;
+    x = x ^ x.shiftLeft<13>();
+    x = x ^ x.shiftRight<17>();
+    x = x ^ x.shiftLeft<5>();
+    _state = x;
+    return x;
+}
+
+}
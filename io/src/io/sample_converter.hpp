@@ -0,0 +1,42 @@
+#pragma once
+
+#include <io/audio_stream_configuration.hpp>
+
+#include <common/simd.hpp>
+
+#include <cstdint>
+#include <span>
+
+namespace io {
+
+//! Turns the mono float the pipeline renders into a device's interleaved frames, four samples at a time.
+//! Integer samples are rounded to the nearest step. 16 and 24 bit ones can be dithered first with TPDF dither (the sum
+//! of two independent uniform values of ±½ LSB), which trades the distortion that rounding adds to quiet signals for a
+//! steady noise floor. 32 bit samples never are: float's 24 bit mantissa is already coarser than their LSB.
+//! Not thread safe: the dither's RNG state changes with every call.
+class SampleConverter {
+public:
+    SampleConverter(SampleFormat format, int numChannels, bool dither, std::uint32_t seed = 1);
+
+    //! Writes each sample of `mono` to every channel of a frame of `out`, which must hold `mono.size()` frames.
+    void convert(std::span<const float> mono, void* out);
+
+private:
+    //! Converts up to four samples, writing the first `count`.
+    void convert(common::simd::Float4 samples, unsigned char* out, std::size_t count);
+
+    //! ±1 LSB, triangular. Advances the RNG twice.
+    [[nodiscard]] common::simd::Float4 nextDither();
+
+    //! A xorshift32 step on every lane.
+    [[nodiscard]] common::simd::Int4 nextRandom();
+
+    SampleFormat _format;
+    int _numChannels;
+    std::size_t _frameSize;
+    float _fullScale;
+    bool _dither;
+    common::simd::Int4 _state;
+};
+
+}
@@ -1,7 +1,10 @@
 #include "synth/audio_pipeline.hpp"
 
+#include "common/block_statistics.hpp"
 #include "common/exception.hpp"
+#include "common/realtime_log.hpp"
 #include "common/timer.hpp"
+#include "common/trace.hpp"
 
 namespace synth {
 
@@ -12,26 +15,27 @@ void logAudioBlockStatistics(const common::audio::FrameBlock& block, double bloc
     }
 
     if (static_cast<double>(computeDuration.count()) > blockDuration_us) {
-        M_WARN("Compute took longer than block duration.");
+        M_RT_WARN("Compute took longer than block duration.");
     }
 
-    for (const auto& sample : block) {
-        if (!std::isfinite(sample)) {
-            M_WARN("Sample is NaN.");
-        };
-
-        if (sample > 1.0f) {
-            M_WARN(fmt::format("Sample higher than 1.0: {}", sample));
-        } else if (sample < -1.0f) {
-            M_WARN(fmt::format("Sample less than -1.0: {}", sample));
-        }
+    const auto statistics = common::audio::analyzeBlock(block);
+    if (statistics.numNonFinite > 0) {
+        M_RT_WARN("{} samples are NaN or infinite.", statistics.numNonFinite);
+    }
+    if (statistics.numClipped > 0) {
+        M_RT_WARN("{} samples are outside of [-1.0, 1.0] (peak: {}).", statistics.numClipped, statistics.peak);
     }
 }
 }
 
 void AudioPipeline::processBlock() {
+    M_TRACE_ZONE("Block");
+
     // Get next input frame input device.
-    auto nextBlockAndInputTime = common::timedInvoke([this] { return _source->getNextBlock(); });
+    auto nextBlockAndInputTime = common::timedInvoke([this] {
+        M_TRACE_ZONE("Source");
+        return _source->getNextBlock();
+    });
 
     // This is necessary because capturing structured bindings is finicky.
     auto nextBlock = nextBlockAndInputTime.first;
@@ -43,6 +47,7 @@ void AudioPipeline::processBlock() {
 
     // Apply effects.
     auto applyEffectsTime = common::timedInvoke([&] {
+        M_TRACE_ZONE("Effects");
         for (const auto& effect : _effects) {
             effect->push(nextBlock);
             nextBlock = effect->getNextBlock();
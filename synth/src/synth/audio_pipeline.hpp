@@ -3,17 +3,35 @@
 #include "common/log.hpp"
 #include "common/midi_handle.hpp"
 #include "common/ring_buffer.hpp"
+#include "common/sample_fifo.hpp"
+
+#include <span>
 
 namespace synth {
 
+//! A midi event, and the sample of the next block it lands on.
+struct ScheduledEvent {
+    common::midi::Event event;
+    std::size_t offset; //< Into the block, below AudioBlockSize.
+};
+
 //! Produces samples, responds to midi events.
 class I_SourceNode {
 public:
     virtual ~I_SourceNode() = default;
     [[nodiscard]] virtual common::audio::FrameBlock getNextBlock() = 0;
 
+    //! The next block, with each of `events` (in order) applied at its offset into it. Sources that can't change course
+    //! mid-block apply them all up front.
+    [[nodiscard]] virtual common::audio::FrameBlock getNextBlockWithEvents(std::span<const ScheduledEvent> events) {
+        for (const auto& scheduled : events) {
+            respondToMidiEvent(scheduled.event);
+        }
+        return getNextBlock();
+    }
+
     //! TODO: remove these.
-    virtual void respondToKeyboardChanges(const common::midi::Keyboard&) {}
+    virtual void respondToMidiEvent(const common::midi::Event&) {}
     [[nodiscard]] virtual double sampleRate() const { return 0.; }
 };
 
@@ -25,16 +43,22 @@ public:
     virtual bool push(const common::audio::FrameBlock& block) = 0;
 };
 
+//! Writes blocks into the FIFO the audio device reads from. The device may read in any size it likes.
 class OutputDevice : public I_SinkNode {
 public:
-    explicit OutputDevice(std::shared_ptr<common::RingBuffer<common::audio::FrameBlock>> buffer) : _buffer{std::move(buffer)} {}
+    explicit OutputDevice(std::shared_ptr<common::SampleFifo> buffer) : _buffer{std::move(buffer)} {}
 
-    [[nodiscard]] bool isFull() const override { return _buffer->isFull(); }
+    //! Full when another whole block wouldn't fit.
+    [[nodiscard]] bool isFull() const override { return _buffer->availableToWrite() < common::audio::AudioBlockSize; }
     bool push(const common::audio::FrameBlock& block) override {
-        return _buffer->push(block);
+        if (isFull()) {
+            return false;
+        }
+        _buffer->write(block);
+        return true;
     }
 private:
-    std::shared_ptr<common::RingBuffer<common::audio::FrameBlock>> _buffer;
+    std::shared_ptr<common::SampleFifo> _buffer;
 };
 
 //! Anything that transforms the signal is a function node. These forward audio from the input to the output, and apply a transformation in between.
@@ -42,17 +66,16 @@ class I_FunctionNode : public I_SourceNode, public I_SinkNode {
 public:
     bool push(const common::audio::FrameBlock& block) override {
         _nextBlock = block;
-        for (auto& sample : _nextBlock) {
-            sample = this->transform(sample);
-        }
+        this->transformBlock(_nextBlock);
         return true;
     }
 
     [[nodiscard]] common::audio::FrameBlock getNextBlock() override { return _nextBlock; }
 
 protected:
-    //! Modifies the input signal. Invoked on every sample in every frame pushed.
-    [[nodiscard]] virtual float transform(float in) = 0;
+    //! Modifies the input signal in place. Invoked once per frame pushed, so parameters shared with other threads
+    //! should be read once here, not once per sample.
+    virtual void transformBlock(common::audio::FrameBlock& block) = 0;
 
 private:
     [[nodiscard]] bool isFull() const final { return false; }
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <common/aligned_buffer.hpp>
+
+#include <bit>
+#include <cmath>
+
+namespace synth {
+
+//! A history of samples in a power-of-two ring, so wrapping is a mask instead of a division.
+//! Reads happen before the write of the current sample: `read(1)` is the previous sample written.
+//! Not thread safe; this belongs to whichever thread processes audio.
+class DelayLine {
+public:
+    //! The ring is sized so that any delay in [1, maxDelaySamples] can be read, including the interpolated neighbour.
+    explicit DelayLine(std::size_t maxDelaySamples) :
+        _memory(std::bit_ceil(maxDelaySamples + 2)),
+        _mask{_memory.size() - 1},
+        _maxDelaySamples{maxDelaySamples} {}
+
+    [[nodiscard]] std::size_t maxDelaySamples() const { return _maxDelaySamples; }
+
+    void write(float in) {
+        _memory[_writeIndex] = in;
+        _writeIndex = (_writeIndex + 1) & _mask;
+    }
+
+    //! Reads a whole number of samples behind the write position.
+    [[nodiscard]] float read(std::size_t delaySamples) const {
+        return _memory[(_writeIndex - delaySamples) & _mask];
+    }
+
+    //! Reads a fractional number of samples behind the write position using linear interpolation.
+    //! `delaySamples` must be in [1, maxDelaySamples].
+    [[nodiscard]] float readInterpolated(float delaySamples) const {
+        const auto whole = static_cast<std::size_t>(delaySamples);
+        const auto fraction = delaySamples - static_cast<float>(whole);
+        const auto newer = _memory[(_writeIndex - whole) & _mask];
+        const auto older = _memory[(_writeIndex - whole - 1) & _mask];
+        return newer + fraction * (older - newer);
+    }
+
+    void clear() {
+        _memory.fill(0.f);
+    }
+
+private:
+    common::AlignedBuffer<float> _memory;
+    std::size_t _mask;
+    std::size_t _maxDelaySamples;
+    std::size_t _writeIndex{0};
+};
+
+}
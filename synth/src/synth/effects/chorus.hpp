@@ -0,0 +1,137 @@
+#pragma once
+
+#include "common/triple_buffer.hpp"
+#include "synth/audio_pipeline.hpp"
+#include "synth/low_frequency_oscillator.hpp"
+#include "synth/modulated_delay_line.hpp"
+#include "synth/smoothed_parameter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace synth {
+
+//! A four-voice chorus: copies of the input, each delayed by a slowly wandering amount, are mixed back in.
+//! Each voice has its own LFO, a quarter cycle apart, so the voices never drift together.
+//! The LFOs are evaluated at control rate; the voices' delays glide in between and are read as one Float4.
+class Chorus : public I_FunctionNode {
+public:
+    static constexpr std::size_t NumVoices = common::simd::Width;
+    static constexpr std::size_t ControlPeriod = 32;
+    static constexpr float MaxDelay_ms = 50.f;
+
+    //! Each voice's delay sweeps `delay_ms` +/- `depth_ms`.
+    Chorus(double sampleRate, float rateHz, float delay_ms, float depth_ms, float mix) :
+        _sampleRate{sampleRate},
+        _parameters{Parameters{rateHz, delay_ms, depth_ms, mix}},
+        _line{static_cast<std::size_t>(std::ceil(MaxDelay_ms * sampleRate / 1000))},
+        _lfos{makeLfos(rateHz, sampleRate)},
+        _rateHz{rateHz},
+        _wetGain{wetGain(mix), sampleRate},
+        _dryGain{dryGain(mix), sampleRate} {
+        _line.setDelays(common::simd::Float4::broadcast(toSamples(delay_ms)));
+
+        // Set here rather than in makeLfos: copying an oscillator resets its phase.
+        for (auto voice = std::size_t{0}; voice < NumVoices; ++voice) {
+            _lfos[voice].setPhase(static_cast<double>(voice) / NumVoices);
+        }
+    }
+
+    void setRateHz(float rateHz) {
+        _parameters.update([&rateHz](Parameters& parameters) { parameters.rateHz = rateHz; });
+    }
+
+    void setDelay_ms(float delay_ms) {
+        _parameters.update([&delay_ms](Parameters& parameters) { parameters.delay_ms = delay_ms; });
+    }
+
+    void setDepth_ms(float depth_ms) {
+        _parameters.update([&depth_ms](Parameters& parameters) { parameters.depth_ms = depth_ms; });
+    }
+
+    //! 0 is dry, 1 is only the delayed voices.
+    void setMix(float mix) {
+        _parameters.update([&mix](Parameters& parameters) { parameters.mix = mix; });
+    }
+
+protected:
+    void transformBlock(common::audio::FrameBlock& block) override {
+        const auto& parameters = _parameters.read();
+        if (parameters.rateHz != _rateHz) {
+            _rateHz = parameters.rateHz;
+            for (auto& lfo : _lfos) {
+                lfo.setFrequency(_rateHz);
+            }
+        }
+
+        _wetGain.setTarget(wetGain(parameters.mix));
+        _dryGain.setTarget(dryGain(parameters.mix));
+        for (auto offset = std::size_t{0}; offset < block.size(); offset += ControlPeriod) {
+            const auto numSamples = std::min(ControlPeriod, block.size() - offset);
+            applyLfos(parameters, numSamples);
+
+            for (auto i = offset; i < offset + numSamples; ++i) {
+                _wet[i] = _line.read().horizontalSum();
+                _line.write(block[i]);
+            }
+        }
+
+        mixWetDry(block, _wet, _dryGain.nextBlock(block.size()), _wetGain.nextBlock(block.size()));
+    }
+
+private:
+    struct Parameters {
+        float rateHz;
+        float delay_ms;
+        float depth_ms;
+        float mix;
+    };
+
+    [[nodiscard]] static std::array<LowFrequencyOscillator, NumVoices> makeLfos(float rateHz, double sampleRate) {
+        return {
+            LowFrequencyOscillator(rateHz, sampleRate, 1.f),
+            LowFrequencyOscillator(rateHz, sampleRate, 1.f),
+            LowFrequencyOscillator(rateHz, sampleRate, 1.f),
+            LowFrequencyOscillator(rateHz, sampleRate, 1.f)};
+    }
+
+    //! The voices are summed, so each gets a share of the mix.
+    [[nodiscard]] static float wetGain(float mix) {
+        return mix / static_cast<float>(NumVoices);
+    }
+
+    [[nodiscard]] static float dryGain(float mix) {
+        return 1.f - mix;
+    }
+
+    [[nodiscard]] float toSamples(float delay_ms) const {
+        return static_cast<float>(delay_ms * _sampleRate / 1000);
+    }
+
+    //! Samples every LFO once, skips them ahead to the next control point, and ramps the voices' delays.
+    void applyLfos(const Parameters& parameters, std::size_t numSamples) {
+        auto lfoOutputs = std::array<float, NumVoices>{};
+        for (auto voice = std::size_t{0}; voice < NumVoices; ++voice) {
+            lfoOutputs[voice] = _lfos[voice].nextSample();
+            _lfos[voice].skip(numSamples - 1);
+        }
+
+        using common::simd::Float4;
+        const auto modulation = Float4::load(lfoOutputs.data()) * Float4::broadcast(toSamples(parameters.depth_ms));
+        _line.rampDelays(Float4::broadcast(toSamples(parameters.delay_ms)) + modulation, numSamples);
+    }
+
+    double _sampleRate;
+    common::TripleBuffer<Parameters> _parameters;
+
+    // Audio thread only.
+    ModulatedDelayLine<NumVoices> _line;
+    std::array<LowFrequencyOscillator, NumVoices> _lfos;
+    float _rateHz;
+    SmoothedParameter _wetGain;
+    SmoothedParameter _dryGain;
+    common::audio::FrameBlock _wet{};
+};
+
+}
@@ -0,0 +1,195 @@
+#include <synth/effects/convolution_reverb.hpp>
+
+#include <common/exception.hpp>
+#include <common/log.hpp>
+#include <common/wav_file.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace synth {
+
+namespace {
+
+//! Loads are smoothed over roughly this many measurements.
+constexpr float LoadSmoothing = 0.01f;
+
+void updateLoad(std::atomic<float>& load, std::chrono::steady_clock::duration elapsed, double budget_s) {
+    const auto instantaneous = static_cast<float>(std::chrono::duration<double>(elapsed).count() / budget_s);
+    const auto previous = load.load(std::memory_order_relaxed);
+    load.store(previous + LoadSmoothing * (instantaneous - previous), std::memory_order_relaxed);
+}
+
+[[nodiscard]] std::vector<float> resampleLinear(const std::vector<float>& in, double ratio) {
+    const auto size = static_cast<std::size_t>(std::floor(static_cast<double>(in.size() - 1) / ratio)) + 1;
+    auto result = std::vector<float>(size);
+    for (auto i = std::size_t{0}; i < size; ++i) {
+        const auto position = static_cast<double>(i) * ratio;
+        const auto index = std::min(static_cast<std::size_t>(position), in.size() - 1);
+        const auto next = std::min(index + 1, in.size() - 1);
+        const auto fraction = static_cast<float>(position - static_cast<double>(index));
+        result[i] = in[index] + fraction * (in[next] - in[index]);
+    }
+    return result;
+}
+
+}
+
+std::vector<float> loadImpulseResponse(const std::filesystem::path& path, double sampleRate) {
+    const auto file = common::audio::readWavFile(path);
+    auto result = file.toMono();
+    if (result.empty()) {
+        throw common::MicrotoneException("Impulse response is empty: " + path.string());
+    }
+
+    if (file.sampleRate != sampleRate) {
+        M_INFO(fmt::format("Resampling impulse response from {} Hz to {} Hz.", file.sampleRate, sampleRate));
+        result = resampleLinear(result, file.sampleRate / sampleRate);
+    }
+    return result;
+}
+
+ConvolutionReverb::ConvolutionReverb(double sampleRate,
+                                     std::span<const float> impulseResponse,
+                                     float wet,
+                                     float dry,
+                                     TailDeadline tailDeadline) :
+    _sampleRate{sampleRate},
+    _impulseResponse_s{static_cast<double>(impulseResponse.size()) / sampleRate},
+    _tailDeadline{tailDeadline},
+    _parameters{Parameters{wet, dry}},
+    _wetGain{wet, sampleRate},
+    _dryGain{dry, sampleRate},
+    _head{impulseResponse.first(std::min(HeadLength, impulseResponse.size())), HeadPartitionSize} {
+    if (impulseResponse.size() <= HeadLength) {
+        return;
+    }
+
+    _tail.emplace(impulseResponse.subspan(HeadLength), TailPartitionSize);
+    for (auto slot = std::size_t{0}; slot < NumTailSlots; ++slot) {
+        _tailInput[slot] = common::AlignedBuffer<float>(TailPartitionSize);
+        _tailOutput[slot] = common::AlignedBuffer<float>(TailPartitionSize);
+    }
+    _tailThread = std::thread(&ConvolutionReverb::tailLoop, this);
+}
+
+ConvolutionReverb::~ConvolutionReverb() {
+    _isRunning = false;
+    if (_tailThread.joinable()) {
+        // Wakes the background thread, which then sees it should stop.
+        _numTailPartitionsSubmitted.fetch_add(1, std::memory_order_release);
+        _numTailPartitionsSubmitted.notify_one();
+        _tailThread.join();
+    }
+}
+
+ConvolutionReverb::Metrics ConvolutionReverb::metrics() const {
+    return {
+        _impulseResponse_s,
+        _headLoad.load(std::memory_order_relaxed),
+        _tailLoad.load(std::memory_order_relaxed),
+        _numLateBlocks.load(std::memory_order_relaxed),
+        _numDroppedTailPartitions.load(std::memory_order_relaxed)};
+}
+
+void ConvolutionReverb::transformBlock(common::audio::FrameBlock& block) {
+    static_assert(HeadPartitionSize == common::audio::AudioBlockSize);
+    const auto start = std::chrono::steady_clock::now();
+    const auto& parameters = _parameters.read();
+
+    _head.process(block.data(), _wet.data());
+    if (_tail) {
+        addTail(block);
+    }
+
+    _wetGain.setTarget(parameters.wet);
+    _dryGain.setTarget(parameters.dry);
+    mixWetDry(block, _wet, _dryGain.nextBlock(block.size()), _wetGain.nextBlock(block.size()));
+    ++_blockIndex;
+
+    updateLoad(_headLoad, std::chrono::steady_clock::now() - start, static_cast<double>(block.size()) / _sampleRate);
+}
+
+void ConvolutionReverb::addTail(const common::audio::FrameBlock& input) {
+    const auto partition = _blockIndex / BlocksPerTailPartition;
+    const auto offset = (_blockIndex % BlocksPerTailPartition) * HeadPartitionSize;
+
+    // The output of tail partition p starts HeadLength samples after its input did: two partitions later.
+    if (partition >= 2) {
+        const auto due = partition - 2;
+        auto numDone = _numTailPartitionsDone.load(std::memory_order_acquire);
+        if (_tailDeadline == TailDeadline::Wait) {
+            while (numDone <= due) {
+                _numTailPartitionsDone.wait(numDone, std::memory_order_acquire);
+                numDone = _numTailPartitionsDone.load(std::memory_order_acquire);
+            }
+        }
+
+        const auto slot = due % NumTailSlots;
+        if (_tailOutputPartitions[slot].load(std::memory_order_acquire) == due + 1) {
+            const auto& output = _tailOutput[slot];
+            for (auto i = std::size_t{0}; i < _wet.size(); ++i) {
+                _wet[i] += output[offset + i];
+            }
+        } else {
+            _numLateBlocks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // The background thread may still be convolving any partition from the oldest it hasn't finished up to the last
+    // one submitted. Three or more partitions behind, that can be the one in this partition's slot: rather than
+    // overwrite its input, this partition is dropped, and never submitted. Once the thread has finished what it has,
+    // it's idle, and the next partition goes through. (Waiting, it's never more than one behind.)
+    if (offset == 0) {
+        const auto numDone = _numTailPartitionsDone.load(std::memory_order_acquire);
+        const auto numSubmitted = _numTailPartitionsSubmitted.load(std::memory_order_relaxed);
+        _isDroppingTailPartition = numDone < numSubmitted && partition >= numDone + NumTailSlots;
+    }
+    if (_isDroppingTailPartition) {
+        return;
+    }
+
+    std::copy(input.begin(), input.end(), _tailInput[partition % NumTailSlots].begin() + offset);
+    if (offset + HeadPartitionSize == TailPartitionSize) {
+        _numTailPartitionsSubmitted.store(partition + 1, std::memory_order_release);
+        _numTailPartitionsSubmitted.notify_one();
+    }
+}
+
+void ConvolutionReverb::tailLoop() {
+    const auto budget_s = static_cast<double>(TailPartitionSize) / _sampleRate;
+    auto next = std::uint64_t{0};
+    while (true) {
+        _numTailPartitionsSubmitted.wait(next, std::memory_order_acquire);
+        if (!_isRunning) {
+            return;
+        }
+
+        for (auto submitted = _numTailPartitionsSubmitted.load(std::memory_order_acquire); _isRunning && next < submitted;
+             submitted = _numTailPartitionsSubmitted.load(std::memory_order_acquire)) {
+            // More than one partition waiting means the oldest is already due. When skipping, convolving it would only
+            // make the next one late too: jump to the newest instead. This also passes over any the audio thread dropped.
+            // The convolver's history assumes consecutive partitions, so it restarts: the tail fades in again.
+            if (_tailDeadline == TailDeadline::Skip && submitted - next > 1) {
+                _numDroppedTailPartitions.fetch_add(submitted - 1 - next, std::memory_order_relaxed);
+                next = submitted - 1;
+                _tail->reset();
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto slot = next % NumTailSlots;
+            _tail->process(_tailInput[slot].data(), _tailOutput[slot].data());
+            updateLoad(_tailLoad, std::chrono::steady_clock::now() - start, budget_s);
+
+            _tailOutputPartitions[slot].store(next + 1, std::memory_order_release);
+            ++next;
+            _numTailPartitionsDone.store(next, std::memory_order_release);
+            _numTailPartitionsDone.notify_one();
+        }
+    }
+}
+
+}
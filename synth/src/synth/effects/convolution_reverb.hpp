@@ -0,0 +1,123 @@
+#pragma once
+
+#include "common/aligned_buffer.hpp"
+#include "common/triple_buffer.hpp"
+#include "synth/audio_pipeline.hpp"
+#include "synth/partitioned_convolver.hpp"
+#include "synth/smoothed_parameter.hpp"
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace synth {
+
+//! Reads a WAV file as a mono impulse response at `sampleRate`, resampling if the file's rate differs.
+[[nodiscard]] std::vector<float> loadImpulseResponse(const std::filesystem::path& path, double sampleRate);
+
+//! A reverb that convolves its input with a recorded impulse response.
+//! The impulse response is split in two:
+//!  - The head, [0, HeadLength), is convolved on the audio thread in partitions of one audio block, so it adds no
+//!    latency beyond the block itself.
+//!  - The tail, [HeadLength, end), is convolved on a background thread in partitions of TailPartitionSize. Larger
+//!    partitions need far fewer operations per sample for a long impulse response. The head is long enough to cover
+//!    the time the tail needs: one partition to collect its input, and one partition to compute it.
+class ConvolutionReverb : public I_FunctionNode {
+public:
+    static constexpr std::size_t HeadPartitionSize = common::audio::AudioBlockSize;
+    static constexpr std::size_t TailPartitionSize = 4 * HeadPartitionSize;
+    static constexpr std::size_t HeadLength = 2 * TailPartitionSize;
+
+    //! What the audio thread does when the background thread hasn't finished a tail partition in time.
+    enum class TailDeadline {
+        Skip, //< Drop that part of the tail (and count it). For realtime playback: a background thread that falls behind
+              //< drops whole partitions until it has caught up, rather than stay behind.
+        Wait  //< Block until it's ready. For offline rendering, which can run much faster than realtime.
+    };
+
+    struct Metrics {
+        double impulseResponse_s{0};
+        float headLoad{0};  //< Time spent on the audio thread, as a fraction of realtime.
+        float tailLoad{0};  //< Time spent on the background thread, as a fraction of realtime.
+        std::size_t numLateBlocks{0};
+        std::size_t numDroppedTailPartitions{0}; //< Never convolved, because the background thread was behind.
+
+        //! The figure to budget with: total load for each second of impulse response.
+        [[nodiscard]] float loadPerSecondOfImpulseResponse() const {
+            return impulseResponse_s > 0 ? static_cast<float>((headLoad + tailLoad) / impulseResponse_s) : 0.f;
+        }
+    };
+
+    ConvolutionReverb(double sampleRate,
+                      std::span<const float> impulseResponse,
+                      float wet,
+                      float dry,
+                      TailDeadline tailDeadline = TailDeadline::Skip);
+    ~ConvolutionReverb() override;
+
+    ConvolutionReverb(const ConvolutionReverb&) = delete;
+    ConvolutionReverb& operator=(const ConvolutionReverb&) = delete;
+
+    void setWet(float wet) {
+        _parameters.update([&wet](Parameters& parameters) { parameters.wet = wet; });
+    }
+
+    void setDry(float dry) {
+        _parameters.update([&dry](Parameters& parameters) { parameters.dry = dry; });
+    }
+
+    [[nodiscard]] Metrics metrics() const;
+
+protected:
+    void transformBlock(common::audio::FrameBlock& block) override;
+
+private:
+    //! Tail input and output are triple buffered: one being filled, one being convolved, and one of slack.
+    static constexpr std::size_t NumTailSlots = 3;
+    static constexpr std::size_t BlocksPerTailPartition = TailPartitionSize / HeadPartitionSize;
+
+    struct Parameters {
+        float wet;
+        float dry;
+    };
+
+    void addTail(const common::audio::FrameBlock& input);
+    void tailLoop();
+
+    double _sampleRate;
+    double _impulseResponse_s;
+    TailDeadline _tailDeadline;
+    common::TripleBuffer<Parameters> _parameters;
+
+    // Audio thread only.
+    SmoothedParameter _wetGain;
+    SmoothedParameter _dryGain;
+    PartitionedConvolver _head;
+    common::audio::FrameBlock _wet{};
+    std::uint64_t _blockIndex{0};
+    bool _isDroppingTailPartition{false};
+
+    // Shared with the background thread, which only exists if the impulse response is longer than the head.
+    std::optional<PartitionedConvolver> _tail;
+    std::array<common::AlignedBuffer<float>, NumTailSlots> _tailInput;
+    std::array<common::AlignedBuffer<float>, NumTailSlots> _tailOutput;
+    //! Which partition (plus one, so 0 is none) each output slot holds. With partitions dropped, that isn't implied by
+    //! how many are done.
+    std::array<std::atomic<std::uint64_t>, NumTailSlots> _tailOutputPartitions{};
+    std::atomic<std::uint64_t> _numTailPartitionsSubmitted{0};
+    std::atomic<std::uint64_t> _numTailPartitionsDone{0};
+    std::atomic<bool> _isRunning{true};
+    std::thread _tailThread;
+
+    // Metrics
+    std::atomic<float> _headLoad{0};
+    std::atomic<float> _tailLoad{0};
+    std::atomic<std::size_t> _numLateBlocks{0};
+    std::atomic<std::size_t> _numDroppedTailPartitions{0};
+};
+
+}
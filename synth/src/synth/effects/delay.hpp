@@ -1,63 +1,93 @@
 #pragma once
 
+#include "common/triple_buffer.hpp"
 #include "synth/audio_pipeline.hpp"
+#include "synth/delay_line.hpp"
+#include "synth/smoothed_parameter.hpp"
+
+#include <algorithm>
+#include <cmath>
 
 namespace synth {
 
 //! Records a history of the samples that pass through this class, then feeds them into the input.
+//! Delay times are fractional. Changes to the time and the gain glide instead of jumping, which avoids clicks.
 class Delay : public I_FunctionNode {
 public:
-    Delay(std::size_t numSamples, float gain) :
-        _state(State{numSamples, gain}) {
-        throwIfInvalid();
-    }
+    static constexpr float DefaultMaxDelay_s = 2.f;
 
-    [[nodiscard]] float transform(float in) override {
-        auto out = in;
-        _state.write([&out, this](State& state) {
-            out += state.gain * state.memory[state.tail];
-
-            state.memory[state.head] = out;
-            state.head = (state.head + 1) % state.memory.size();
-            state.tail = (state.tail + 1) % state.memory.size();
-        });
-        return out;
+    //! Memory for `maxDelay_s` of history at `sampleRate` is allocated here, once.
+    Delay(double sampleRate, float delay_s, float gain, float maxDelay_s = DefaultMaxDelay_s) :
+        _sampleRate{sampleRate},
+        _parameters{Parameters{delay_s, gain}},
+        _state{sampleRate, maxDelay_s, delay_s, gain} {
+        throwIfInvalid(delay_s);
     }
 
-    void setDelay(std::size_t numSamples) {
-        _state.write([&numSamples](State& state) {
-            state.head = numSamples;
-            state.tail = 0;
-        });
+    //! Values outside of (0, maxDelay_s] are clamped.
+    void setDelay_s(float delay_s) {
+        _parameters.update([&delay_s](Parameters& parameters) { parameters.delay_s = delay_s; });
     }
 
     void setGain(float gain) {
-        _state.write([&gain](State& state) {
-            state.gain = gain;
-        });
+        _parameters.update([&gain](Parameters& parameters) { parameters.gain = gain; });
+    }
+
+protected:
+    void transformBlock(common::audio::FrameBlock& block) override {
+        const auto& parameters = _parameters.read();
+        const auto targetDelay = toClampedSamples(parameters.delay_s);
+        _state.gain.setTarget(parameters.gain);
+        const auto gain = _state.gain.nextBlock(block.size());
+
+        for (auto i = std::size_t{0}; i < block.size(); ++i) {
+            _state.currentDelay += (targetDelay - _state.currentDelay) * _state.smoothing;
+
+            block[i] += gain[i] * _state.memory.readInterpolated(static_cast<float>(_state.currentDelay));
+            _state.memory.write(block[i]);
+        }
     }
 
 private:
-    void throwIfInvalid() const {
-        const auto& state = _state.read();
-        const auto delay = state.head - state.tail;
-        if (delay == 0 || delay >= state.memory.size()) {
+    //! The time constant of delay time changes.
+    static constexpr double DelaySmoothing_s = 0.05;
+
+    [[nodiscard]] double toClampedSamples(float delay_s) const {
+        const auto delay = delay_s * _sampleRate;
+        return std::clamp(delay, 1., static_cast<double>(_state.memory.maxDelaySamples()));
+    }
+
+    void throwIfInvalid(float delay_s) const {
+        const auto delay = delay_s * _sampleRate;
+        if (delay < 1 || delay > static_cast<double>(_state.memory.maxDelaySamples())) {
             throw common::MicrotoneException("Delay duration is outside of allowable bounds.");
         }
     }
 
-    struct State {
-        State(std::size_t numSamples, float gain) : head{numSamples}, gain{gain} {}
+    struct Parameters {
+        float delay_s;
+        float gain;
+    };
 
-        // This class supports a delay of up to 1s at a sample rate of 48 kHz.
-        std::array<float, 48000> memory{0.f};
-        std::size_t head{0};
-        std::size_t tail{0};
+    //! Owned by the audio thread.
+    struct State {
+        State(double sampleRate, float maxDelay_s, float delay_s, float gain) :
+            memory{static_cast<std::size_t>(std::ceil(maxDelay_s * sampleRate))},
+            currentDelay{delay_s * sampleRate},
+            smoothing{1.0 - std::exp(-1.0 / (DelaySmoothing_s * sampleRate))},
+            gain{gain, sampleRate} {}
 
-        float gain{1.f};
+        DelayLine memory;
+        //! In samples; glides toward the requested delay. Double, because at tens of thousands of samples a float's
+        //! steps are coarser than the glide's last increments, which would round away short of the target.
+        double currentDelay;
+        double smoothing; //< One-pole coefficient for `currentDelay`.
+        SmoothedParameter gain;
     };
 
-    common::MutexProtected<State> _state;
+    double _sampleRate;
+    common::TripleBuffer<Parameters> _parameters;
+    State _state;
 };
 
-}
\ No newline at end of file
+}
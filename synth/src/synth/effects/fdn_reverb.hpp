@@ -0,0 +1,183 @@
+#pragma once
+
+#include "common/aligned_buffer.hpp"
+#include "common/simd.hpp"
+#include "common/triple_buffer.hpp"
+#include "synth/audio_pipeline.hpp"
+#include "synth/smoothed_parameter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+
+namespace synth {
+
+//! An algorithmic reverb: a feedback delay network (FDN) of eight delay lines, mixed by a Householder matrix.
+//! Much cheaper than convolution, and the decay time is a parameter rather than a recording.
+//!
+//! The eight lines are two Float4s. They share one ring buffer with an interleaved layout (all eight lines' samples
+//! for a given time are adjacent), so writing the network's state is two vector stores. Reads have a different
+//! delay per line, so they're gathered. The Householder matrix I - (2/N) * 1 * 1^T is lossless and mixes every line
+//! into every other; it only needs the sum of the lines, so it costs one horizontal add instead of a matrix multiply.
+//! Decay and damping changes glide (see SmoothedParameter): the feedback gains are recomputed at the end of each block
+//! while they do, and interpolated sample by sample in between.
+//! All memory is allocated on construction.
+class FDNReverb : public I_FunctionNode {
+public:
+    static constexpr std::size_t NumLines = 8;
+
+    //! Roughly mutually prime lengths between 30 and 75 ms, so the echoes of different lines rarely coincide.
+    static constexpr std::array<double, NumLines> DelayTimes_ms{29.7, 37.1, 41.1, 43.7, 53.3, 59.9, 67.7, 73.1};
+
+    //! `decay_s` is the time to decay by 60 dB. `damping` in [0, 1) is how much faster high frequencies decay.
+    FDNReverb(double sampleRate, float decay_s, float damping, float wet, float dry) :
+        _sampleRate{sampleRate},
+        _parameters{Parameters{decay_s, damping, wet, dry}},
+        _delays{computeDelays(sampleRate)},
+        _memory{std::bit_ceil(*std::ranges::max_element(_delays) + 1) * NumLines},
+        _mask{_memory.size() / NumLines - 1},
+        _feedback{computeFeedback(decay_s, damping)},
+        _decay_s{decay_s, sampleRate},
+        _damping{damping, sampleRate},
+        _wetGain{wet * OutputScale, sampleRate},
+        _dryGain{dry, sampleRate} {}
+
+    void setDecay_s(float decay_s) {
+        _parameters.update([&decay_s](Parameters& parameters) { parameters.decay_s = decay_s; });
+    }
+
+    void setDamping(float damping) {
+        _parameters.update([&damping](Parameters& parameters) { parameters.damping = damping; });
+    }
+
+    void setWet(float wet) {
+        _parameters.update([&wet](Parameters& parameters) { parameters.wet = wet; });
+    }
+
+    void setDry(float dry) {
+        _parameters.update([&dry](Parameters& parameters) { parameters.dry = dry; });
+    }
+
+protected:
+    void transformBlock(common::audio::FrameBlock& block) override {
+        using common::simd::Float4;
+
+        const auto& parameters = _parameters.read();
+        _decay_s.setTarget(parameters.decay_s);
+        _damping.setTarget(parameters.damping);
+        _wetGain.setTarget(parameters.wet * OutputScale);
+        _dryGain.setTarget(parameters.dry);
+
+        // A step in the feedback gains clicks like any other. While they move, each sample steps a block's worth of
+        // change along; otherwise the steps are zero.
+        auto feedback = _feedback;
+        auto step = Feedback{};
+        const auto decay_s = _decay_s.nextBlock(block.size());
+        const auto damping = _damping.nextBlock(block.size());
+        if (!decay_s.isConstant() || !damping.isConstant()) {
+            _feedback = computeFeedback(decay_s.value(), damping.value());
+            const auto scale = Float4::broadcast(1.f / static_cast<float>(block.size()));
+            step.gainsLow = (_feedback.gainsLow - feedback.gainsLow) * scale;
+            step.gainsHigh = (_feedback.gainsHigh - feedback.gainsHigh) * scale;
+            step.dampingCoefficient = (_feedback.dampingCoefficient - feedback.dampingCoefficient) * scale;
+        }
+
+        // Inputs and outputs alternate in sign across the lines, which keeps the output from collapsing to mono-like
+        // comb filtering at the start of the tail.
+        const auto signs = Float4::fromLanes(1.f, -1.f, 1.f, -1.f);
+        const auto inputScale = Float4::broadcast(0.25f);
+        const auto householder = Float4::broadcast(-2.f / static_cast<float>(NumLines));
+
+        auto* memory = _memory.data();
+        for (auto i = std::size_t{0}; i < block.size(); ++i) {
+            // Gather the output of each line.
+            alignas(16) auto taps = std::array<float, NumLines>{};
+            for (auto line = std::size_t{0}; line < NumLines; ++line) {
+                taps[line] = memory[((_writeIndex - _delays[line]) & _mask) * NumLines + line];
+            }
+            auto low = Float4::load(taps.data());
+            auto high = Float4::load(taps.data() + common::simd::Width);
+
+            // Frequency-dependent absorption: a one-pole low-pass, then the gain for each line's length.
+            feedback.gainsLow = feedback.gainsLow + step.gainsLow;
+            feedback.gainsHigh = feedback.gainsHigh + step.gainsHigh;
+            feedback.dampingCoefficient = feedback.dampingCoefficient + step.dampingCoefficient;
+            _dampedLow = _dampedLow + feedback.dampingCoefficient * (low - _dampedLow);
+            _dampedHigh = _dampedHigh + feedback.dampingCoefficient * (high - _dampedHigh);
+            low = _dampedLow * feedback.gainsLow;
+            high = _dampedHigh * feedback.gainsHigh;
+
+            _wet[i] = (low * signs + high * signs).horizontalSum();
+
+            // Householder feedback, plus the input.
+            const auto feedback = householder * Float4::broadcast((low + high).horizontalSum());
+            const auto in = Float4::broadcast(block[i]) * inputScale * signs;
+            (low + feedback + in).store(memory + _writeIndex * NumLines);
+            (high + feedback + in).store(memory + _writeIndex * NumLines + common::simd::Width);
+            _writeIndex = (_writeIndex + 1) & _mask;
+        }
+
+        mixWetDry(block, _wet, _dryGain.nextBlock(block.size()), _wetGain.nextBlock(block.size()));
+    }
+
+private:
+    //! Keeps the wet signal near the level of the input.
+    static constexpr float OutputScale = 0.35f;
+
+    struct Parameters {
+        float decay_s;
+        float damping;
+        float wet;
+        float dry;
+    };
+
+    //! What decay and damping come down to in the network.
+    struct Feedback {
+        common::simd::Float4 gainsLow{common::simd::Float4::zero()};
+        common::simd::Float4 gainsHigh{common::simd::Float4::zero()};
+        common::simd::Float4 dampingCoefficient{common::simd::Float4::zero()};
+    };
+
+    [[nodiscard]] static std::array<std::size_t, NumLines> computeDelays(double sampleRate) {
+        auto result = std::array<std::size_t, NumLines>{};
+        for (auto line = std::size_t{0}; line < NumLines; ++line) {
+            result[line] = std::max<std::size_t>(1, static_cast<std::size_t>(DelayTimes_ms[line] * sampleRate / 1000));
+        }
+        return result;
+    }
+
+    //! Each line loses 60 dB over `decay_s`, in proportion to its length, so all lines decay at the same rate.
+    [[nodiscard]] Feedback computeFeedback(float decay_s, float damping) const {
+        decay_s = std::max(decay_s, 0.01f);
+        auto gains = std::array<float, NumLines>{};
+        for (auto line = std::size_t{0}; line < NumLines; ++line) {
+            const auto delay_s = static_cast<double>(_delays[line]) / _sampleRate;
+            gains[line] = static_cast<float>(std::pow(10.0, -3.0 * delay_s / decay_s));
+        }
+        return {common::simd::Float4::load(gains.data()),
+                common::simd::Float4::load(gains.data() + common::simd::Width),
+                common::simd::Float4::broadcast(1.f - std::clamp(damping, 0.f, 0.99f))};
+    }
+
+    double _sampleRate;
+    common::TripleBuffer<Parameters> _parameters;
+
+    // Audio thread only.
+    std::array<std::size_t, NumLines> _delays;
+    common::AlignedBuffer<float> _memory;
+    std::size_t _mask;
+    std::size_t _writeIndex{0};
+
+    Feedback _feedback; //< At the end of the last block.
+    common::simd::Float4 _dampedLow{common::simd::Float4::zero()};
+    common::simd::Float4 _dampedHigh{common::simd::Float4::zero()};
+
+    SmoothedParameter _decay_s;
+    SmoothedParameter _damping;
+    SmoothedParameter _wetGain;
+    SmoothedParameter _dryGain;
+    common::audio::FrameBlock _wet{};
+};
+
+}
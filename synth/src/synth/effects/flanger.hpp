@@ -0,0 +1,122 @@
+#pragma once
+
+#include "common/triple_buffer.hpp"
+#include "synth/audio_pipeline.hpp"
+#include "synth/low_frequency_oscillator.hpp"
+#include "synth/modulated_delay_line.hpp"
+#include "synth/smoothed_parameter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace synth {
+
+//! A flanger: one very short, swept delay mixed with the input, with feedback. The comb filter this creates sweeps up
+//! and down with the LFO. The LFO is evaluated at control rate, and the delay glides in between.
+class Flanger : public I_FunctionNode {
+public:
+    static constexpr std::size_t ControlPeriod = 32;
+    static constexpr float MaxDelay_ms = 20.f;
+
+    //! The delay sweeps `delay_ms` +/- `depth_ms`. `feedback` is clamped to (-1, 1); negative values hollow out the
+    //! sound instead of ringing.
+    Flanger(double sampleRate, float rateHz, float delay_ms, float depth_ms, float feedback, float mix) :
+        _sampleRate{sampleRate},
+        _parameters{Parameters{rateHz, delay_ms, depth_ms, feedback, mix}},
+        _line{static_cast<std::size_t>(std::ceil(MaxDelay_ms * sampleRate / 1000))},
+        _lfo{rateHz, sampleRate, 1.f},
+        _rateHz{rateHz},
+        _feedback{clampFeedback(feedback), sampleRate},
+        _wetGain{wetGain(mix), sampleRate},
+        _dryGain{1.f - wetGain(mix), sampleRate} {
+        _line.setDelays(common::simd::Float4::broadcast(toSamples(delay_ms)));
+    }
+
+    void setRateHz(float rateHz) {
+        _parameters.update([&rateHz](Parameters& parameters) { parameters.rateHz = rateHz; });
+    }
+
+    void setDelay_ms(float delay_ms) {
+        _parameters.update([&delay_ms](Parameters& parameters) { parameters.delay_ms = delay_ms; });
+    }
+
+    void setDepth_ms(float depth_ms) {
+        _parameters.update([&depth_ms](Parameters& parameters) { parameters.depth_ms = depth_ms; });
+    }
+
+    void setFeedback(float feedback) {
+        _parameters.update([&feedback](Parameters& parameters) { parameters.feedback = feedback; });
+    }
+
+    //! 0 is dry, 1 is an equal blend of input and delay (the deepest notches).
+    void setMix(float mix) {
+        _parameters.update([&mix](Parameters& parameters) { parameters.mix = mix; });
+    }
+
+protected:
+    void transformBlock(common::audio::FrameBlock& block) override {
+        const auto& parameters = _parameters.read();
+        if (parameters.rateHz != _rateHz) {
+            _rateHz = parameters.rateHz;
+            _lfo.setFrequency(_rateHz);
+        }
+
+        _feedback.setTarget(clampFeedback(parameters.feedback));
+        _wetGain.setTarget(wetGain(parameters.mix));
+        _dryGain.setTarget(1.f - wetGain(parameters.mix));
+        const auto feedback = _feedback.nextBlock(block.size());
+        for (auto offset = std::size_t{0}; offset < block.size(); offset += ControlPeriod) {
+            const auto numSamples = std::min(ControlPeriod, block.size() - offset);
+
+            const auto lfoOutput = _lfo.nextSample();
+            _lfo.skip(numSamples - 1);
+            const auto delay = toSamples(parameters.delay_ms + lfoOutput * parameters.depth_ms);
+            _line.rampDelays(common::simd::Float4::broadcast(delay), numSamples);
+
+            for (auto i = offset; i < offset + numSamples; ++i) {
+                _wet[i] = _line.read().first();
+                _line.write(block[i] + feedback[i] * _wet[i]);
+            }
+        }
+
+        mixWetDry(block, _wet, _dryGain.nextBlock(block.size()), _wetGain.nextBlock(block.size()));
+    }
+
+private:
+    static constexpr float MaxFeedback = 0.95f;
+
+    struct Parameters {
+        float rateHz;
+        float delay_ms;
+        float depth_ms;
+        float feedback;
+        float mix;
+    };
+
+    [[nodiscard]] static float clampFeedback(float feedback) {
+        return std::clamp(feedback, -MaxFeedback, MaxFeedback);
+    }
+
+    //! At most an equal blend of input and delay.
+    [[nodiscard]] static float wetGain(float mix) {
+        return 0.5f * mix;
+    }
+
+    [[nodiscard]] float toSamples(float delay_ms) const {
+        return static_cast<float>(delay_ms * _sampleRate / 1000);
+    }
+
+    double _sampleRate;
+    common::TripleBuffer<Parameters> _parameters;
+
+    // Audio thread only.
+    ModulatedDelayLine<1> _line;
+    LowFrequencyOscillator _lfo;
+    float _rateHz;
+    SmoothedParameter _feedback;
+    SmoothedParameter _wetGain;
+    SmoothedParameter _dryGain;
+    common::audio::FrameBlock _wet{};
+};
+
+}
@@ -1,37 +1,30 @@
 #pragma once
 
+#include "common/triple_buffer.hpp"
 #include "synth/audio_pipeline.hpp"
 #include "synth/math.hpp"
+#include "synth/smoothed_parameter.hpp"
 
 namespace synth {
 
 //! Implements an analog high-pass filter, discretized using the forward Euler method.
 //! Note: High cutoffs perform poorly with the forward Euler method. The Tustin method is apparently better (less shallow)
-class HighPassFilter : public I_FunctionNode {
+//! This is the DSP only; it isn't thread safe and belongs to whichever thread processes audio.
+class HighPassKernel {
 public:
-    HighPassFilter(double sampleRate, float cutoffFrequencyHz) :
-        _state(State{sampleRate, cutoffFrequencyHz}) {}
+    HighPassKernel(double sampleRate, float cutoffFrequencyHz) :
+        _sampleRate{sampleRate},
+        _alpha{computeAlpha(sampleRate, cutoffFrequencyHz)} {}
 
-    HighPassFilter(const HighPassFilter& other) : _state(other._state) {}
-    HighPassFilter& operator=(const HighPassFilter& other) {
-        _state = other._state;
-        return *this;
-    }
-
-    [[nodiscard]] float transform(float in) override {
-        auto out = in;
-        _state.write([&](State& state) {
-            out = state.alpha * (in  - state.lastInput + state.lastOutput);
-            state.lastInput = in;
-            state.lastOutput = out;
-        });
+    [[nodiscard]] float nextSample(float in) {
+        const auto out = _alpha * (in - _lastInput + _lastOutput);
+        _lastInput = in;
+        _lastOutput = out;
         return out;
     }
 
     void setCutoffFrequencyHz(float frequencyHz) {
-        _state.write([&frequencyHz](State& state) {
-            state.alpha = computeAlpha(state.sampleRate, frequencyHz);
-        });
+        _alpha = computeAlpha(_sampleRate, frequencyHz);
     }
 
 private:
@@ -41,21 +34,56 @@ private:
         return RC / (T + RC);
     }
 
-    struct State {
-        State(double sampleRate, float cutoffFrequencyHz) :
-            sampleRate{sampleRate},
-            alpha{computeAlpha(sampleRate, cutoffFrequencyHz)} {}
+    float _lastInput{0};
+    float _lastOutput{0};
 
-        float lastInput{0};
-        float lastOutput{0};
+    double _sampleRate{44100.0};
 
-        double sampleRate{44100.0};
+    // Precomputed for performance.
+    float _alpha;
+};
+
+//! A high-pass filter effect. The cutoff can be changed from any thread; the audio thread picks it up once per block.
+//! Cutoff changes glide (see SmoothedParameter), so sweeping it doesn't click.
+class HighPassFilter : public I_FunctionNode {
+public:
+    HighPassFilter(double sampleRate, float cutoffFrequencyHz) :
+        _parameters{Parameters{cutoffFrequencyHz}},
+        _kernel{sampleRate, cutoffFrequencyHz},
+        _cutoffFrequencyHz{cutoffFrequencyHz, sampleRate} {}
 
-        // Precomputed for performance.
-        float alpha;
+    void setCutoffFrequencyHz(float frequencyHz) {
+        _parameters.write(Parameters{frequencyHz});
+    }
+
+protected:
+    void transformBlock(common::audio::FrameBlock& block) override {
+        _cutoffFrequencyHz.setTarget(_parameters.read().cutoffFrequencyHz);
+        const auto cutoffHz = _cutoffFrequencyHz.nextBlock(block.size());
+        if (cutoffHz.isConstant()) {
+            // The kernel already has it: the last glide ended on it.
+            for (auto& sample : block) {
+                sample = _kernel.nextSample(sample);
+            }
+            return;
+        }
+
+        for (auto i = std::size_t{0}; i < block.size(); ++i) {
+            _kernel.setCutoffFrequencyHz(cutoffHz[i]);
+            block[i] = _kernel.nextSample(block[i]);
+        }
+    }
+
+private:
+    struct Parameters {
+        float cutoffFrequencyHz;
     };
 
-    common::MutexProtected<State> _state;
+    common::TripleBuffer<Parameters> _parameters;
+
+    // Audio thread only.
+    HighPassKernel _kernel;
+    SmoothedParameter _cutoffFrequencyHz;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common/block_statistics.hpp"
+#include "synth/audio_pipeline.hpp"
+
+#include <atomic>
+
+namespace synth {
+
+//! A pass-through node that measures every block it sees. Readings are published with atomics, so the UI can poll
+//! them from any thread without ever blocking the audio thread.
+class LevelMeter : public I_FunctionNode {
+public:
+    struct Reading {
+        float peak{0.f};
+        float rms{0.f};
+        std::size_t numClipped{0};   //< Total since construction.
+        std::size_t numNonFinite{0}; //< Total since construction.
+    };
+
+    LevelMeter() = default;
+
+    [[nodiscard]] Reading reading() const {
+        return {
+            _peak.load(std::memory_order_relaxed),
+            _rms.load(std::memory_order_relaxed),
+            _numClipped.load(std::memory_order_relaxed),
+            _numNonFinite.load(std::memory_order_relaxed)};
+    }
+
+protected:
+    void transformBlock(common::audio::FrameBlock& block) override {
+        const auto statistics = common::audio::analyzeBlock(block);
+        _peak.store(statistics.peak, std::memory_order_relaxed);
+        _rms.store(statistics.rms, std::memory_order_relaxed);
+        _numClipped.fetch_add(statistics.numClipped, std::memory_order_relaxed);
+        _numNonFinite.fetch_add(statistics.numNonFinite, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<float> _peak{0.f};
+    std::atomic<float> _rms{0.f};
+    std::atomic<std::size_t> _numClipped{0};
+    std::atomic<std::size_t> _numNonFinite{0};
+};
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "common/aligned_buffer.hpp"
+#include "common/triple_buffer.hpp"
+#include "synth/audio_pipeline.hpp"
+#include "synth/delay_line.hpp"
+#include "synth/peak_detection.hpp"
+#include "synth/smoothed_parameter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace synth {
+
+//! A look-ahead true-peak limiter: keeps the output below a ceiling without clipping, by turning the gain down
+//! smoothly *before* each peak arrives. The audio is delayed by the look-ahead time (plus the true-peak detector's
+//! delay) so the gain can start moving early.
+//!
+//! Per sample:
+//!  1. The true peak of the incoming signal is estimated (4x oversampled, see TruePeakDetector).
+//!  2. The gain needed to bring that peak to the ceiling is held for the look-ahead window (a sliding maximum).
+//!  3. That gain is released slowly when it rises, and averaged over the look-ahead window. The average reaches the
+//!     held gain exactly when the peak leaves the delay, so the output never overshoots, and the attack is a smooth
+//!     ramp instead of a click.
+//! Like the clamp it replaces, this should be the last stage before the output.
+//! Ceiling changes glide (see SmoothedParameter), so the gain follows them smoothly too.
+class Limiter : public I_FunctionNode {
+public:
+    static constexpr float DefaultCeiling_dB = -1.f;
+    static constexpr float DefaultLookAhead_ms = 1.5f;
+    static constexpr float DefaultRelease_ms = 60.f;
+
+    struct Metrics {
+        std::size_t latencySamples{0};
+        double latency_ms{0};
+        float gainReduction_dB{0};    //< The most gain reduction applied in the last block, as a positive number.
+        float maxGainReduction_dB{0}; //< The most since construction.
+    };
+
+    explicit Limiter(double sampleRate,
+                     float ceiling_dB = DefaultCeiling_dB,
+                     float release_ms = DefaultRelease_ms,
+                     float lookAhead_ms = DefaultLookAhead_ms) :
+        _sampleRate{sampleRate},
+        _parameters{Parameters{ceiling_dB, release_ms}},
+        _lookAhead{std::max<std::size_t>(1, static_cast<std::size_t>(lookAhead_ms * sampleRate / 1000))},
+        _peakHold{_lookAhead + 1},
+        _audio{_lookAhead + TruePeakDetector::Delay},
+        _gainHistory{_lookAhead},
+        _ceiling{toAmplitude(ceiling_dB), sampleRate} {
+        // The averaging window starts full of unity gain.
+        _gainHistory.fill(1.f);
+        _gainSum = static_cast<double>(_lookAhead);
+    }
+
+    void setCeiling_dB(float ceiling_dB) {
+        _parameters.update([&ceiling_dB](Parameters& parameters) { parameters.ceiling_dB = ceiling_dB; });
+    }
+
+    void setRelease_ms(float release_ms) {
+        _parameters.update([&release_ms](Parameters& parameters) { parameters.release_ms = release_ms; });
+    }
+
+    [[nodiscard]] std::size_t latencySamples() const {
+        return _lookAhead + TruePeakDetector::Delay;
+    }
+
+    [[nodiscard]] Metrics metrics() const {
+        return {
+            latencySamples(),
+            static_cast<double>(latencySamples()) * 1000 / _sampleRate,
+            _gainReduction_dB.load(std::memory_order_relaxed),
+            _maxGainReduction_dB.load(std::memory_order_relaxed)};
+    }
+
+protected:
+    void transformBlock(common::audio::FrameBlock& block) override {
+        const auto& parameters = _parameters.read();
+        _ceiling.setTarget(toAmplitude(parameters.ceiling_dB));
+        const auto ceiling = _ceiling.nextBlock(block.size());
+        const auto release = static_cast<float>(1.0 - std::exp(-1000.0 / (std::max(parameters.release_ms, 1.f) * _sampleRate)));
+        const auto averageScale = 1.0 / static_cast<double>(_lookAhead);
+
+        auto minGain = 1.f;
+        for (auto i = std::size_t{0}; i < block.size(); ++i) {
+            auto& sample = block[i];
+            const auto peak = _peakHold.push(_detector.push(sample));
+            const auto target = peak > ceiling[i] ? ceiling[i] / peak : 1.f;
+
+            // Instant attack and slow release, then an average over the look-ahead window.
+            _releasedGain = target < _releasedGain ? target : _releasedGain + release * (target - _releasedGain);
+            _gainSum += _releasedGain - _gainHistory[_gainIndex];
+            _gainHistory[_gainIndex] = _releasedGain;
+            if (++_gainIndex == _lookAhead) {
+                // Re-summing once per window stops rounding errors from accumulating.
+                _gainIndex = 0;
+                _gainSum = 0;
+                for (const auto g : _gainHistory) {
+                    _gainSum += g;
+                }
+            }
+            const auto gain = static_cast<float>(_gainSum * averageScale);
+
+            const auto delayed = _audio.read(latencySamples());
+            _audio.write(sample);
+            sample = delayed * gain;
+            minGain = std::min(minGain, gain);
+        }
+
+        const auto gainReduction_dB = -20 * std::log10(minGain);
+        _gainReduction_dB.store(gainReduction_dB, std::memory_order_relaxed);
+        if (gainReduction_dB > _maxGainReduction_dB.load(std::memory_order_relaxed)) {
+            _maxGainReduction_dB.store(gainReduction_dB, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Parameters {
+        float ceiling_dB;
+        float release_ms;
+    };
+
+    [[nodiscard]] static float toAmplitude(float level_dB) {
+        return std::pow(10.f, level_dB / 20);
+    }
+
+    double _sampleRate;
+    common::TripleBuffer<Parameters> _parameters;
+
+    // Audio thread only.
+    std::size_t _lookAhead;
+    TruePeakDetector _detector;
+    SlidingMaximum _peakHold;
+    DelayLine _audio;
+
+    float _releasedGain{1.f};
+    common::AlignedBuffer<float> _gainHistory; //< The last `_lookAhead` released gains, averaged.
+    std::size_t _gainIndex{0};
+    double _gainSum;
+    SmoothedParameter _ceiling; //< As an amplitude.
+
+    // Metrics
+    std::atomic<float> _gainReduction_dB{0};
+    std::atomic<float> _maxGainReduction_dB{0};
+};
+
+}
@@ -1,36 +1,30 @@
 #pragma once
 
+#include "common/triple_buffer.hpp"
 #include "synth/audio_pipeline.hpp"
 #include "synth/math.hpp"
+#include "synth/smoothed_parameter.hpp"
 
 namespace synth {
 
 //! Implements an analog low-pass filter, discretized using the forward Euler method.
-class LowPassFilter : public I_FunctionNode {
+//! This is the DSP only; it isn't thread safe and belongs to whichever thread processes audio.
+class LowPassKernel {
 public:
-    LowPassFilter(double sampleRate, float cutoffFrequencyHz) :
-        _state(State{sampleRate, cutoffFrequencyHz}) {}
+    LowPassKernel(double sampleRate, float cutoffFrequencyHz) :
+        _sampleRate{sampleRate},
+        _alpha{computeAlpha(sampleRate, cutoffFrequencyHz)},
+        _beta{computeBeta(sampleRate, cutoffFrequencyHz)} {}
 
-    LowPassFilter(const LowPassFilter& other) : _state(other._state) {}
-    LowPassFilter& operator=(const LowPassFilter& other) {
-        _state = other._state;
-        return *this;
-    }
-
-    [[nodiscard]] float transform(float in) override {
-        auto out = in;
-        _state.write([&](State& state) {
-            out = state.alpha * in + state.beta * state.lastOutput;
-            state.lastOutput = out;
-        });
+    [[nodiscard]] float nextSample(float in) {
+        const auto out = _alpha * in + _beta * _lastOutput;
+        _lastOutput = out;
         return out;
     }
 
     void setCutoffFrequencyHz(float frequencyHz) {
-        _state.write([&frequencyHz](State& state) {
-            state.alpha = computeAlpha(state.sampleRate, frequencyHz);
-            state.beta = computeBeta(state.sampleRate, frequencyHz);
-        });
+        _alpha = computeAlpha(_sampleRate, frequencyHz);
+        _beta = computeBeta(_sampleRate, frequencyHz);
     }
 
 private:
@@ -46,22 +40,56 @@ private:
         return RC / (T + RC);
     }
 
-    struct State {
-        State(double sampleRate, float cutoffFrequencyHz) :
-            sampleRate{sampleRate},
-            alpha{computeAlpha(sampleRate, cutoffFrequencyHz)},
-            beta{computeBeta(sampleRate, cutoffFrequencyHz)} {}
+    float _lastOutput{0};
 
-        float lastOutput{0};
+    double _sampleRate{44100.0};
 
-        double sampleRate{44100.0};
+    // Precomputed for performance.
+    float _alpha;
+    float _beta;
+};
+
+//! A low-pass filter effect. The cutoff can be changed from any thread; the audio thread picks it up once per block.
+//! Cutoff changes glide (see SmoothedParameter), so sweeping it doesn't click.
+class LowPassFilter : public I_FunctionNode {
+public:
+    LowPassFilter(double sampleRate, float cutoffFrequencyHz) :
+        _parameters{Parameters{cutoffFrequencyHz}},
+        _kernel{sampleRate, cutoffFrequencyHz},
+        _cutoffFrequencyHz{cutoffFrequencyHz, sampleRate} {}
 
-        // Precomputed for performance.
-        float alpha;
-        float beta;
+    void setCutoffFrequencyHz(float frequencyHz) {
+        _parameters.write(Parameters{frequencyHz});
+    }
+
+protected:
+    void transformBlock(common::audio::FrameBlock& block) override {
+        _cutoffFrequencyHz.setTarget(_parameters.read().cutoffFrequencyHz);
+        const auto cutoffHz = _cutoffFrequencyHz.nextBlock(block.size());
+        if (cutoffHz.isConstant()) {
+            // The kernel already has it: the last glide ended on it.
+            for (auto& sample : block) {
+                sample = _kernel.nextSample(sample);
+            }
+            return;
+        }
+
+        for (auto i = std::size_t{0}; i < block.size(); ++i) {
+            _kernel.setCutoffFrequencyHz(cutoffHz[i]);
+            block[i] = _kernel.nextSample(block[i]);
+        }
+    }
+
+private:
+    struct Parameters {
+        float cutoffFrequencyHz;
     };
 
-    common::MutexProtected<State> _state;
+    common::TripleBuffer<Parameters> _parameters;
+
+    // Audio thread only.
+    LowPassKernel _kernel;
+    SmoothedParameter _cutoffFrequencyHz;
 };
 
-}
\ No newline at end of file
+}
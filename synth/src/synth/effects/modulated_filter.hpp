@@ -1,88 +1,140 @@
 #pragma once
 
+#include "common/triple_buffer.hpp"
 #include "synth/audio_pipeline.hpp"
-#include "synth/effects/high_pass_filter.hpp"
-#include "synth/effects/low_pass_filter.hpp"
 #include "synth/low_frequency_oscillator.hpp"
+#include "synth/smoothed_parameter.hpp"
+#include "synth/state_variable_filter.hpp"
 
-#include <variant>
+#include <algorithm>
 
 namespace synth {
 
-enum class FilterType {
-    LowPass = 0,
-    HighPass
-};
-
-//! A filter whose cutoff frequency is modulated by a low frequency oscillator.
+//! A resonant state-variable filter whose cutoff frequency is modulated by a low frequency oscillator.
+//! The LFO and the filter coefficients are evaluated at control rate (every `controlPeriod` samples), and the
+//! coefficients are linearly interpolated in between.
+//! Type and resonance changes are also ramped over one control period, so switching between them doesn't click.
+//! Cutoff and LFO depth changes glide (see SmoothedParameter), and are sampled at each control point.
 class ModulatedFilter : public I_FunctionNode {
 public:
-    ModulatedFilter(double sampleRate, FilterType type, float cutoffFrequencyHz, float lfoDepthHz, float lfoFrequencyHz) :
-        _state(State{
-            makeFilter(type, sampleRate, cutoffFrequencyHz),
+    //! 32 samples is ~0.7 ms at 48 kHz: far faster than any LFO, so stepping isn't audible.
+    static constexpr std::size_t DefaultControlPeriod = 32;
+
+    //! Two stages: 24 dB/oct.
+    static constexpr std::size_t DefaultNumStages = 2;
+
+    ModulatedFilter(double sampleRate,
+                    FilterType type,
+                    float cutoffFrequencyHz,
+                    float resonance,
+                    float lfoDepthHz,
+                    float lfoFrequencyHz,
+                    std::size_t controlPeriod = DefaultControlPeriod,
+                    std::size_t numStages = DefaultNumStages) :
+        _parameters{Parameters{type, cutoffFrequencyHz, resonance, lfoDepthHz, lfoFrequencyHz, std::max<std::size_t>(controlPeriod, 1)}},
+        _state{
+            CascadedStateVariableFilter(sampleRate, type, cutoffFrequencyHz, resonance, numStages),
             LowFrequencyOscillator(lfoFrequencyHz, sampleRate, 1.0),
+            SmoothedParameter(cutoffFrequencyHz, sampleRate),
+            SmoothedParameter(lfoDepthHz, sampleRate),
             sampleRate,
-            cutoffFrequencyHz,
-            lfoDepthHz}) {}
-
-    [[nodiscard]] float transform(float in) override {
-        auto out = in;
-        _state.write([&out](State& state) {
-            applyLFOToFilterCutoff(state.lfo, state.filter, state.cutoffFrequencyHz, state.lfoDepthHz);
-            out = std::visit([&out](auto& f) { return f.transform(out); }, state.filter);
-        });
-        return out;
-    }
+            lfoFrequencyHz} {}
 
     void setFilterType(FilterType type) {
-        _state.write([&](State& state) { state.filter = makeFilter(type, state.sampleRate, state.cutoffFrequencyHz); });
+        _parameters.update([&](Parameters& parameters) { parameters.type = type; });
+    }
+
+    //! In [0, 1). Only the last stage of the cascade resonates.
+    void setResonance(float resonance) {
+        _parameters.update([&](Parameters& parameters) { parameters.resonance = resonance; });
     }
 
     void setCutoffFrequencyHz(float frequencyHz) {
-        _state.write([&](State& state) { state.cutoffFrequencyHz = frequencyHz; });
+        _parameters.update([&](Parameters& parameters) { parameters.cutoffFrequencyHz = frequencyHz; });
     }
 
     void setLFODepthHz(float depthHz) {
-        _state.write([&](State& state) { state.lfoDepthHz = depthHz; });
+        _parameters.update([&](Parameters& parameters) { parameters.lfoDepthHz = depthHz; });
     }
 
     void setLFOFrequencyHz(float frequencyHz) {
-        _state.write([&](State& state) {
-            state.lfo.setFrequency(frequencyHz);
-        });
+        _parameters.update([&](Parameters& parameters) { parameters.lfoFrequencyHz = frequencyHz; });
     }
 
-private:
-    using FilterT = std::variant<LowPassFilter, HighPassFilter>;
-
-    [[nodiscard]] static FilterT makeFilter(FilterType type, double sampleRate, float cutoffFrequencyHz) {
-        switch (type) {
-        case FilterType::LowPass:
-            return LowPassFilter(sampleRate, cutoffFrequencyHz);
-        case FilterType::HighPass:
-            return HighPassFilter(sampleRate, cutoffFrequencyHz);
-        default:
-            throw common::MicrotoneException("Unsupported filter type.");
-        }
+    //! The number of samples between evaluations of the LFO and the filter coefficients.
+    void setControlPeriod(std::size_t numSamples) {
+        _parameters.update([&](Parameters& parameters) { parameters.controlPeriod = std::max<std::size_t>(numSamples, 1); });
     }
 
-    //! The core function of this class: sweeping the filter cutoff up and down using the LFO.
-    static void applyLFOToFilterCutoff(LowFrequencyOscillator& lfo, FilterT& filterVariant, float baseFrequencyHz, float frequencyDepthHz) {
-        auto lfoOutput = lfo.nextSample();
-        auto newCutoff = baseFrequencyHz + lfoOutput * frequencyDepthHz;
-        std::visit([&newCutoff](auto& f) { f.setCutoffFrequencyHz(newCutoff); }, filterVariant);
+protected:
+    void transformBlock(common::audio::FrameBlock& block) override {
+        const auto& parameters = _parameters.read();
+        applyParameters(_state, parameters);
+        const auto cutoffHz = _state.cutoffFrequencyHz.nextBlock(block.size());
+        const auto lfoDepthHz = _state.lfoDepthHz.nextBlock(block.size());
+
+        for (auto offset = std::size_t{0}; offset < block.size(); offset += parameters.controlPeriod) {
+            const auto numSamples = std::min(parameters.controlPeriod, block.size() - offset);
+            const auto controlPoint = offset + numSamples - 1;
+            applyLFOToFilterCutoff(_state, cutoffHz[controlPoint], lfoDepthHz[controlPoint], numSamples);
+            for (auto i = offset; i < offset + numSamples; ++i) {
+                block[i] = _state.filter.nextSampleRamped(block[i]);
+            }
+        }
     }
 
+private:
+    static constexpr float MinCutoffFrequencyHz = 10.f;
+
+    struct Parameters {
+        FilterType type;
+        float cutoffFrequencyHz;
+        float resonance;
+        float lfoDepthHz;
+        float lfoFrequencyHz;
+        std::size_t controlPeriod;
+    };
+
+    //! Owned by the audio thread.
     struct State {
-        FilterT filter;
+        CascadedStateVariableFilter filter;
         LowFrequencyOscillator lfo;
+        SmoothedParameter cutoffFrequencyHz;
+        SmoothedParameter lfoDepthHz;
 
         double sampleRate;
-        float cutoffFrequencyHz;
-        float lfoDepthHz;
+
+        // The LFO frequency currently applied to `lfo`.
+        float lfoFrequencyHz;
     };
 
-    common::MutexProtected<State> _state;
+    static void applyParameters(State& state, const Parameters& parameters) {
+        // Cheap to set every block; both only take effect with the next coefficient ramp.
+        state.filter.setType(parameters.type);
+        state.filter.setResonance(parameters.resonance);
+        state.cutoffFrequencyHz.setTarget(parameters.cutoffFrequencyHz);
+        state.lfoDepthHz.setTarget(parameters.lfoDepthHz);
+        if (parameters.lfoFrequencyHz != state.lfoFrequencyHz) {
+            state.lfo.setFrequency(parameters.lfoFrequencyHz);
+            state.lfoFrequencyHz = parameters.lfoFrequencyHz;
+        }
+    }
+
+    //! The core function of this class: sweeping the filter cutoff up and down using the LFO.
+    //! The LFO is sampled once, then skipped ahead to the next control point. The filter ramps toward the new cutoff
+    //! over the following `numSamples` samples.
+    static void applyLFOToFilterCutoff(State& state, float cutoffFrequencyHz, float lfoDepthHz, std::size_t numSamples) {
+        auto lfoOutput = state.lfo.nextSample();
+        state.lfo.skip(numSamples - 1);
+
+        // The cutoff must stay positive and below Nyquist, even when the LFO depth exceeds the base frequency.
+        const auto maxCutoffHz = static_cast<float>(0.45 * state.sampleRate);
+        auto newCutoff = std::clamp(cutoffFrequencyHz + lfoOutput * lfoDepthHz, MinCutoffFrequencyHz, maxCutoffHz);
+        state.filter.rampCutoffFrequencyHz(newCutoff, numSamples);
+    }
+
+    common::TripleBuffer<Parameters> _parameters;
+    State _state;
 };
 
-}
\ No newline at end of file
+}
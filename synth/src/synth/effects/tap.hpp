@@ -0,0 +1,80 @@
+#pragma once
+
+#include "common/block_pool.hpp"
+#include "common/broadcast_ring.hpp"
+#include "synth/audio_pipeline.hpp"
+
+namespace synth {
+
+//! A pass-through node that broadcasts every block it sees, so other threads (the UI, a recorder, meters) can each
+//! follow the audio at that point in the pipeline at their own pace. Publishing never waits on them.
+//! Each block is copied once, into a pooled block; readers all share that copy through SharedBlock handles.
+class Tap : public I_FunctionNode {
+public:
+    //! ~170 ms of audio at 48 kHz: how far behind a reader can fall before it starts missing blocks.
+    static constexpr std::size_t NumBlocks = 16;
+
+    //! The ring holds a handle to each of its blocks; the rest are for readers to hold on to.
+    static constexpr std::size_t PoolSize = 2 * NumBlocks;
+
+    using Ring = common::BroadcastRing<common::audio::BlockRef, NumBlocks>;
+
+    //! A consumer's position in the tap. Each reader belongs to one thread; create one per consumer.
+    class Reader {
+    public:
+        Reader(Ring::Reader reader, common::audio::BlockPool& pool) :
+            _reader{reader},
+            _pool{&pool} {}
+
+        //! Shares the next unread block into `out`. Returns false if there isn't one yet.
+        [[nodiscard]] bool tryRead(common::audio::SharedBlock& out) noexcept {
+            auto ref = common::audio::BlockRef{};
+            while (_reader.tryRead(ref)) {
+                if (out = _pool->tryShare(ref); out) {
+                    return true;
+                }
+                // Recycled before this reader got to it.
+                ++_numRecycled;
+            }
+            return false;
+        }
+
+        //! Blocks published before this reader got to them.
+        [[nodiscard]] std::uint64_t numDropped() const noexcept { return _reader.numDropped() + _numRecycled; }
+
+    private:
+        Ring::Reader _reader;
+        common::audio::BlockPool* _pool;
+        std::uint64_t _numRecycled{0};
+    };
+
+    Tap() = default;
+
+    //! A reader that starts with the next block through the tap. The tap must outlive it, and every block it shares.
+    [[nodiscard]] Reader subscribe() const {
+        return {_ring.subscribe(), _pool};
+    }
+
+protected:
+    void transformBlock(common::audio::FrameBlock& block) override {
+        auto shared = _pool.acquire();
+        if (!shared) {
+            // Readers are holding on to every spare block; they'll see a gap.
+            return;
+        }
+        shared.mutableBlock() = block;
+        _ring.publish(shared.ref());
+
+        // Releases the ring's handle to the block this one displaces.
+        _published[_numPublished++ % NumBlocks] = std::move(shared);
+    }
+
+private:
+    //! Sharing a block only touches its (atomic) reference count, so readers may do it through a const Tap.
+    mutable common::audio::BlockPool _pool{PoolSize};
+    Ring _ring;
+    std::array<common::audio::SharedBlock, NumBlocks> _published{};
+    std::size_t _numPublished{0};
+};
+
+}
@@ -0,0 +1,98 @@
+#include <synth/fft.hpp>
+
+#include <common/exception.hpp>
+#include <synth/math.hpp>
+
+#include <bit>
+#include <utility>
+
+namespace synth {
+
+RealFFT::RealFFT(std::size_t size) :
+    _size{size},
+    _twiddles{size / 4},
+    _realTwiddles{size / 2 + 1},
+    _bitReversed{size / 2},
+    _work{size / 2} {
+    if (size < 4 || !std::has_single_bit(size)) {
+        throw common::MicrotoneException("FFT size must be a power of two, and at least 4.");
+    }
+
+    const auto halfSize = size / 2;
+    for (auto k = std::size_t{0}; k < _twiddles.size(); ++k) {
+        _twiddles[k] = std::polar(1.f, static_cast<float>(-2 * M_PI * static_cast<double>(k) / static_cast<double>(halfSize)));
+    }
+    for (auto k = std::size_t{0}; k < _realTwiddles.size(); ++k) {
+        _realTwiddles[k] = std::polar(1.f, static_cast<float>(-2 * M_PI * static_cast<double>(k) / static_cast<double>(size)));
+    }
+
+    const auto numBits = std::countr_zero(halfSize);
+    for (auto i = std::size_t{0}; i < halfSize; ++i) {
+        auto reversed = std::uint32_t{0};
+        for (auto bit = 0; bit < numBits; ++bit) {
+            reversed |= static_cast<std::uint32_t>((i >> bit) & 1) << (numBits - 1 - bit);
+        }
+        _bitReversed[i] = reversed;
+    }
+}
+
+void RealFFT::forward(const float* in, float* re, float* im) {
+    const auto halfSize = _size / 2;
+    for (auto k = std::size_t{0}; k < halfSize; ++k) {
+        _work[k] = {in[2 * k], in[2 * k + 1]};
+    }
+    transform(false);
+
+    // Separate the spectra of the even and odd samples, then combine them with one more butterfly.
+    for (auto k = std::size_t{0}; k <= halfSize; ++k) {
+        const auto z = _work[k % halfSize];
+        const auto zMirror = std::conj(_work[(halfSize - k) % halfSize]);
+        const auto even = 0.5f * (z + zMirror);
+        const auto odd = Complex{0.f, -0.5f} * (z - zMirror);
+        const auto x = even + _realTwiddles[k] * odd;
+        re[k] = x.real();
+        im[k] = x.imag();
+    }
+}
+
+void RealFFT::inverse(const float* re, const float* im, float* out) {
+    const auto halfSize = _size / 2;
+    for (auto k = std::size_t{0}; k < halfSize; ++k) {
+        const auto x = Complex{re[k], im[k]};
+        const auto xMirror = Complex{re[halfSize - k], -im[halfSize - k]};
+        const auto even = x + xMirror;
+        const auto odd = (x - xMirror) * std::conj(_realTwiddles[k]);
+        _work[k] = even + Complex{0.f, 1.f} * odd;
+    }
+    transform(true);
+
+    for (auto k = std::size_t{0}; k < halfSize; ++k) {
+        out[2 * k] = _work[k].real();
+        out[2 * k + 1] = _work[k].imag();
+    }
+}
+
+void RealFFT::transform(bool isInverse) {
+    const auto n = _work.size();
+    for (auto i = std::size_t{0}; i < n; ++i) {
+        if (const auto j = std::size_t{_bitReversed[i]}; i < j) {
+            std::swap(_work[i], _work[j]);
+        }
+    }
+
+    for (auto length = std::size_t{2}; length <= n; length *= 2) {
+        const auto halfLength = length / 2;
+        const auto twiddleStride = n / length;
+        for (auto start = std::size_t{0}; start < n; start += length) {
+            for (auto j = std::size_t{0}; j < halfLength; ++j) {
+                const auto twiddle = isInverse ? std::conj(_twiddles[j * twiddleStride]) : _twiddles[j * twiddleStride];
+                const auto u = _work[start + j];
+                const auto v = _work[start + j + halfLength] * twiddle;
+                _work[start + j] = u + v;
+                _work[start + j + halfLength] = u - v;
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <common/aligned_buffer.hpp>
+
+#include <complex>
+#include <cstdint>
+
+namespace synth {
+
+//! A radix-2 FFT of real signals. Tables and scratch memory are allocated once, on construction, so `forward` and
+//! `inverse` are safe to call from the audio thread.
+//! Spectra are split into separate real and imaginary arrays of `numBins()` values, which keeps the per-bin arithmetic
+//! of callers (e.g. complex multiply-accumulate) easy to vectorize.
+//! Internally, a real signal of size N is packed into a complex signal of size N/2, which halves the work.
+class RealFFT {
+public:
+    //! `size` must be a power of two, and at least 4.
+    explicit RealFFT(std::size_t size);
+
+    [[nodiscard]] std::size_t size() const { return _size; }
+    [[nodiscard]] std::size_t numBins() const { return _size / 2 + 1; }
+
+    //! Reads `size()` samples and writes `numBins()` bins.
+    void forward(const float* in, float* re, float* im);
+
+    //! Reads `numBins()` bins and writes `size()` samples. Unnormalized: the output is scaled by `size()`.
+    void inverse(const float* re, const float* im, float* out);
+
+private:
+    using Complex = std::complex<float>;
+
+    //! An in-place, unnormalized complex FFT of `_work`.
+    void transform(bool isInverse);
+
+    std::size_t _size;
+
+    common::AlignedBuffer<Complex> _twiddles;     //< exp(-2 pi i k / (size / 2)), for the complex transform.
+    common::AlignedBuffer<Complex> _realTwiddles; //< exp(-2 pi i k / size), for packing and unpacking.
+    common::AlignedBuffer<std::uint32_t> _bitReversed;
+    common::AlignedBuffer<Complex> _work;
+};
+
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <common/realtime_log.hpp>
+#include <common/trace.hpp>
+
 #include <memory>
 #include <thread>
 
@@ -10,13 +13,16 @@ namespace synth {
 class Instrument {
 public:
     Instrument() = delete;
-    Instrument(std::shared_ptr<const common::midi::TwoReaderMidiHandle> midiHandle, AudioPipeline&& pipeline) :
+    Instrument(std::shared_ptr<const common::midi::MidiHandle> midiHandle, AudioPipeline&& pipeline) :
         _pipeline(std::move(pipeline)),
         _midiHandle(std::move(midiHandle)),
         _midiReaderId(_midiHandle->registerReader()) {}
 
     ~Instrument() {
         this->stop();
+        if (_midiReaderId) {
+            _midiHandle->unregisterReader(*_midiReaderId);
+        }
     }
 
     void start() {
@@ -32,12 +38,18 @@ public:
 
 private:
     void processLoop() {
+        common::RealtimeLog::markThreadRealtime();
+        M_TRACE_THREAD("Instrument");
         while (_running) {
             if (!_midiReaderId) {
                 throw common::MicrotoneException("Uninitialized (no midi reader ID).");
             }
-            if (_midiHandle->hasChanges(*_midiReaderId)) {
-                _pipeline.getSource().respondToKeyboardChanges(_midiHandle->read(*_midiReaderId));
+            {
+                M_TRACE_ZONE("Midi");
+                auto event = common::midi::Event{};
+                while (_midiHandle->pop(*_midiReaderId, event)) {
+                    _pipeline.getSource().respondToMidiEvent(event);
+                }
             }
             if (_pipeline.shouldProcessBlock()) {
                 _pipeline.processBlock();
@@ -46,7 +58,7 @@ private:
     }
 
     AudioPipeline _pipeline;
-    std::shared_ptr<const common::midi::TwoReaderMidiHandle> _midiHandle;
+    std::shared_ptr<const common::midi::MidiHandle> _midiHandle;
     std::optional<std::size_t> _midiReaderId;
 
     std::atomic<bool> _running{false};
@@ -17,6 +17,16 @@ public:
         return _oscillator.nextSample(_weightedWaveTable);
     }
 
+    //! Advances the phase as if `numSamples` samples were taken. Useful for evaluating the LFO at control rate.
+    void skip(std::size_t numSamples) {
+        _oscillator.skip(numSamples);
+    }
+
+    //! Sets the phase, as a fraction of one cycle in [0, 1). Staggered phases decorrelate LFOs of the same rate.
+    void setPhase(double phase) {
+        _oscillator.setPhase(phase);
+    }
+
     void setFrequency(float frequencyHz) {
         _oscillator.setFrequency(frequencyHz);
     }
@@ -4,4 +4,5 @@
 
 #ifdef WIN32
 constexpr auto M_PI = 3.14159265358979323846;
+constexpr auto M_SQRT2 = 1.41421356237309504880;
 #endif
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "common/exception.hpp"
+#include "common/midi_file.hpp"
+#include "synth/audio_pipeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace synth {
+
+//! Plays a MIDI file through another source (the synthesizer), sample accurately: each event lands on the sample its
+//! tempo-mapped time rounds to, wherever that falls in a block. It counts rendered samples instead of watching a clock,
+//! so a file plays the same whether the pipeline runs in realtime (in an Instrument) or offline (in an
+//! OfflineRenderer), on every run: real repertoire as a repeatable workload.
+//! Live midi sent to it still reaches the source, at the start of the next block.
+class MidiFilePlayer : public I_SourceNode {
+public:
+    MidiFilePlayer() = delete;
+    MidiFilePlayer(std::shared_ptr<I_SourceNode> source, const common::midi::MidiFile& file) :
+        _source(std::move(source)) {
+        const auto sampleRate = _source->sampleRate();
+        if (sampleRate <= 0) {
+            throw common::MicrotoneException("Playing a MIDI file needs a source with a sample rate.");
+        }
+
+        _events.reserve(file.events.size());
+        for (const auto& event : file.events) {
+            const auto position = std::llround(static_cast<double>(event.timestamp_ns) * 1e-9 * sampleRate);
+            _events.push_back({event, static_cast<std::uint64_t>(position)});
+        }
+
+        // Room for the busiest block, so playback never allocates.
+        auto maxEventsPerBlock = std::size_t{0};
+        for (auto first = std::size_t{0}; first < _events.size();) {
+            const auto block = _events[first].position / common::audio::AudioBlockSize;
+            auto last = first;
+            while (last < _events.size() && _events[last].position / common::audio::AudioBlockSize == block) {
+                ++last;
+            }
+            maxEventsPerBlock = std::max(maxEventsPerBlock, last - first);
+            first = last;
+        }
+        _blockEvents.reserve(maxEventsPerBlock);
+    }
+
+    [[nodiscard]] common::audio::FrameBlock getNextBlock() override {
+        const auto blockEnd = _position + common::audio::AudioBlockSize;
+        _blockEvents.clear();
+        for (; _nextEvent < _events.size() && _events[_nextEvent].position < blockEnd; ++_nextEvent) {
+            const auto& timed = _events[_nextEvent];
+            _blockEvents.push_back({timed.event, static_cast<std::size_t>(timed.position - _position)});
+        }
+        _position = blockEnd;
+        return _source->getNextBlockWithEvents(_blockEvents);
+    }
+
+    void respondToMidiEvent(const common::midi::Event& event) override {
+        _source->respondToMidiEvent(event);
+    }
+
+    [[nodiscard]] double sampleRate() const override {
+        return _source->sampleRate();
+    }
+
+    //! Every event has been played. The source may well still be sounding (releases, for one).
+    [[nodiscard]] bool isFinished() const {
+        return _nextEvent == _events.size();
+    }
+
+private:
+    struct TimedEvent {
+        common::midi::Event event;
+        std::uint64_t position; //< In samples from the start.
+    };
+
+    std::shared_ptr<I_SourceNode> _source;
+    std::vector<TimedEvent> _events;
+    std::size_t _nextEvent{0};
+    std::uint64_t _position{0};
+    std::vector<ScheduledEvent> _blockEvents;
+};
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <common/simd.hpp>
+#include <synth/delay_line.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace synth {
+
+//! A delay line with up to four read taps whose delays move continuously: the building block of chorus, flanger and
+//! vibrato effects. Tap delays are set at control rate and glide linearly, sample by sample, in between.
+//! The taps occupy the lanes of a Float4: their delays are ramped and their interpolation is computed together. Only
+//! the two neighbouring samples of each tap are read one at a time, since every tap reads a different position.
+//! Not thread safe; this belongs to whichever thread processes audio.
+template <std::size_t NumTaps = common::simd::Width>
+class ModulatedDelayLine {
+    static_assert(NumTaps >= 1 && NumTaps <= common::simd::Width);
+
+public:
+    using Float4 = common::simd::Float4;
+
+    explicit ModulatedDelayLine(std::size_t maxDelaySamples) :
+        _line{maxDelaySamples},
+        _maxDelay{Float4::broadcast(static_cast<float>(maxDelaySamples))} {}
+
+    [[nodiscard]] std::size_t maxDelaySamples() const { return _line.maxDelaySamples(); }
+
+    //! Jumps the taps to `delaySamples`. Lanes past `NumTaps` are ignored, and delays are clamped to
+    //! [1, maxDelaySamples].
+    void setDelays(Float4 delaySamples) {
+        _delays = clamp(delaySamples);
+        _step = Float4::zero();
+    }
+
+    //! Moves the taps linearly to `delaySamples` over the next `numSamples` calls to `read`.
+    void rampDelays(Float4 delaySamples, std::size_t numSamples) {
+        const auto scale = Float4::broadcast(1.f / static_cast<float>(std::max<std::size_t>(numSamples, 1)));
+        _step = (clamp(delaySamples) - _delays) * scale;
+    }
+
+    //! Reads every tap, with linear interpolation, then advances the ramp. Call before `write`.
+    [[nodiscard]] Float4 read() {
+        _delays = _delays + _step;
+
+        const auto delays = _delays.lanes();
+        alignas(16) auto fractions = std::array<float, common::simd::Width>{};
+        alignas(16) auto newer = std::array<float, common::simd::Width>{};
+        alignas(16) auto older = std::array<float, common::simd::Width>{};
+        for (auto tap = std::size_t{0}; tap < NumTaps; ++tap) {
+            const auto whole = static_cast<std::size_t>(delays[tap]);
+            fractions[tap] = delays[tap] - static_cast<float>(whole);
+            newer[tap] = _line.read(whole);
+            older[tap] = _line.read(whole + 1);
+        }
+
+        const auto newerSamples = Float4::load(newer.data());
+        return newerSamples + Float4::load(fractions.data()) * (Float4::load(older.data()) - newerSamples);
+    }
+
+    void write(float in) {
+        _line.write(in);
+    }
+
+    void clear() {
+        _line.clear();
+    }
+
+private:
+    [[nodiscard]] Float4 clamp(Float4 delaySamples) const {
+        return min(max(delaySamples, Float4::broadcast(1.f)), _maxDelay);
+    }
+
+    DelayLine _line;
+    Float4 _maxDelay;
+    Float4 _delays{Float4::broadcast(1.f)};
+    Float4 _step{Float4::zero()};
+};
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "common/exception.hpp"
+#include "common/midi_handle.hpp"
+#include "synth/audio_pipeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <span>
+
+namespace synth {
+
+struct RenderStatistics {
+    double rendered_s{0};
+    double elapsed_s{0};
+    std::size_t numBlocks{0};
+
+    //! Seconds of audio rendered per second of wall-clock time ("×RT"). Above 1 is faster than realtime.
+    [[nodiscard]] double realtimeFactor() const {
+        return elapsed_s == 0 ? 0 : rendered_s / elapsed_s;
+    }
+};
+
+//! Runs a pipeline on the calling thread as fast as it can, with scripted midi instead of live input. Pair it with a
+//! sink that's never full (WavFileSink) to batch-render or benchmark without a sound card.
+//! Events are applied at the first block boundary at or after their timestamp. For sample accurate timing, play them
+//! through a MidiFilePlayer source instead.
+class OfflineRenderer {
+public:
+    OfflineRenderer() = delete;
+    explicit OfflineRenderer(AudioPipeline&& pipeline) :
+        _pipeline(std::move(pipeline)) {}
+
+    //! Renders `duration_s` seconds, which must be positive. Event timestamps are offsets from the start of the render, in order.
+    [[nodiscard]] RenderStatistics render(std::span<const common::midi::Event> events, double duration_s) {
+        auto& source = _pipeline.getSource();
+        const auto sampleRate = source.sampleRate();
+        if (sampleRate <= 0) {
+            throw common::MicrotoneException("Offline rendering needs a source with a sample rate.");
+        }
+        if (!(duration_s > 0 && std::isfinite(duration_s))) {
+            throw common::MicrotoneException("Offline rendering needs a positive, finite duration.");
+        }
+        if (!std::is_sorted(events.begin(), events.end(), [](const auto& a, const auto& b) { return a.timestamp_ns < b.timestamp_ns; })) {
+            throw common::MicrotoneException("Scripted midi events must be in order.");
+        }
+
+        const auto numBlocks = static_cast<std::size_t>(std::ceil(duration_s * sampleRate / common::audio::AudioBlockSize));
+        const auto blockDuration_ns = 1e9 * common::audio::AudioBlockSize / sampleRate;
+
+        auto nextEvent = events.begin();
+        const auto start = std::chrono::steady_clock::now();
+        for (auto block = std::size_t{0}; block < numBlocks; ++block) {
+            const auto blockStart_ns = static_cast<std::uint64_t>(static_cast<double>(block) * blockDuration_ns);
+            for (; nextEvent != events.end() && nextEvent->timestamp_ns <= blockStart_ns; ++nextEvent) {
+                source.respondToMidiEvent(*nextEvent);
+            }
+            if (!_pipeline.shouldProcessBlock()) {
+                throw common::MicrotoneException("Offline rendering needs a sink that's never full.");
+            }
+            _pipeline.processBlock();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        return {
+            .rendered_s = static_cast<double>(numBlocks * common::audio::AudioBlockSize) / sampleRate,
+            .elapsed_s = std::chrono::duration<double>(elapsed).count(),
+            .numBlocks = numBlocks};
+    }
+
+private:
+    AudioPipeline _pipeline;
+};
+
+}
@@ -44,6 +44,16 @@ public:
         _increment = toIncrement(frequency, _sampleRate);
     }
 
+    //! Sets the phase, as a fraction of one cycle in [0, 1).
+    void setPhase(double phase) {
+        _currentIndex = std::fmod(phase - std::floor(phase), 1.0) * WAVETABLE_LENGTH;
+    }
+
+    //! Advances the phase as if `numSamples` samples were taken.
+    void skip(std::size_t numSamples) {
+        _currentIndex = std::fmod(_currentIndex + _increment * static_cast<double>(numSamples), WAVETABLE_LENGTH);
+    }
+
 private:
     [[nodiscard]] static double toIncrement(double frequency, double sampleRate) {
         return WAVETABLE_LENGTH * frequency / sampleRate;
@@ -0,0 +1,95 @@
+#include <synth/partitioned_convolver.hpp>
+
+#include <common/exception.hpp>
+#include <common/simd.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace synth {
+
+namespace {
+
+[[nodiscard]] std::size_t roundUpToSimdWidth(std::size_t n) {
+    return (n + common::simd::Width - 1) / common::simd::Width * common::simd::Width;
+}
+
+//! acc += a * b, for complex numbers in split form. `n` must be a multiple of the SIMD width.
+void complexMultiplyAccumulate(float* accRe, float* accIm, const float* aRe, const float* aIm, const float* bRe, const float* bIm, std::size_t n) {
+    using common::simd::Float4;
+    for (auto i = std::size_t{0}; i < n; i += common::simd::Width) {
+        const auto ar = Float4::load(aRe + i);
+        const auto ai = Float4::load(aIm + i);
+        const auto br = Float4::load(bRe + i);
+        const auto bi = Float4::load(bIm + i);
+        (Float4::load(accRe + i) + ar * br - ai * bi).store(accRe + i);
+        (Float4::load(accIm + i) + ar * bi + ai * br).store(accIm + i);
+    }
+}
+
+}
+
+PartitionedConvolver::PartitionedConvolver(std::span<const float> impulseResponse, std::size_t partitionSize) :
+    _partitionSize{partitionSize},
+    _numPartitions{std::max<std::size_t>(1, (impulseResponse.size() + partitionSize - 1) / std::max<std::size_t>(partitionSize, 1))},
+    _binStride{roundUpToSimdWidth(partitionSize + 1)},
+    _fft{2 * partitionSize},
+    _impulseResponseRe{_numPartitions * _binStride},
+    _impulseResponseIm{_numPartitions * _binStride},
+    _inputRe{_numPartitions * _binStride},
+    _inputIm{_numPartitions * _binStride},
+    _inputWindow{2 * partitionSize},
+    _accumulatorRe{_binStride},
+    _accumulatorIm{_binStride},
+    _output{2 * partitionSize} {
+    if (!std::has_single_bit(partitionSize)) {
+        throw common::MicrotoneException("Convolution partition size must be a power of two.");
+    }
+
+    // Each partition is zero-padded to the FFT size, and the inverse FFT's scale is folded in here.
+    const auto scale = 1.f / static_cast<float>(_fft.size());
+    auto padded = common::AlignedBuffer<float>(_fft.size());
+    for (auto partition = std::size_t{0}; partition < _numPartitions; ++partition) {
+        const auto begin = std::min(partition * partitionSize, impulseResponse.size());
+        const auto end = std::min(begin + partitionSize, impulseResponse.size());
+        padded.fill(0.f);
+        std::transform(impulseResponse.begin() + begin, impulseResponse.begin() + end, padded.begin(), [scale](float x) { return x * scale; });
+        _fft.forward(padded.data(), &_impulseResponseRe[spectrumOffset(partition)], &_impulseResponseIm[spectrumOffset(partition)]);
+    }
+}
+
+void PartitionedConvolver::process(const float* in, float* out) {
+    // Slide the window along by one partition.
+    std::copy_n(_inputWindow.data() + _partitionSize, _partitionSize, _inputWindow.data());
+    std::copy_n(in, _partitionSize, _inputWindow.data() + _partitionSize);
+
+    _newestInput = (_newestInput + _numPartitions - 1) % _numPartitions;
+    _fft.forward(_inputWindow.data(), &_inputRe[spectrumOffset(_newestInput)], &_inputIm[spectrumOffset(_newestInput)]);
+
+    // Input spectrum k partitions old meets impulse response partition k.
+    _accumulatorRe.fill(0.f);
+    _accumulatorIm.fill(0.f);
+    for (auto partition = std::size_t{0}; partition < _numPartitions; ++partition) {
+        const auto input = spectrumOffset((_newestInput + partition) % _numPartitions);
+        const auto impulseResponse = spectrumOffset(partition);
+        complexMultiplyAccumulate(_accumulatorRe.data(),
+                                  _accumulatorIm.data(),
+                                  &_inputRe[input],
+                                  &_inputIm[input],
+                                  &_impulseResponseRe[impulseResponse],
+                                  &_impulseResponseIm[impulseResponse],
+                                  _binStride);
+    }
+
+    // The first half of the result is circular wrap-around, and is discarded.
+    _fft.inverse(_accumulatorRe.data(), _accumulatorIm.data(), _output.data());
+    std::copy_n(_output.data() + _partitionSize, _partitionSize, out);
+}
+
+void PartitionedConvolver::reset() {
+    _inputRe.fill(0.f);
+    _inputIm.fill(0.f);
+    _inputWindow.fill(0.f);
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <common/aligned_buffer.hpp>
+#include <synth/fft.hpp>
+
+#include <span>
+
+namespace synth {
+
+//! Convolution with a fixed impulse response, using uniformly partitioned overlap-save (UPOLS).
+//! The impulse response is split into partitions of `partitionSize` samples, each transformed once on construction.
+//! Every call to `process` costs one forward and one inverse FFT of size 2 * `partitionSize`, plus one complex
+//! multiply-accumulate per partition, instead of one multiply-add per impulse response sample per output sample.
+//! Latency is one partition: a full partition of input is needed before its output can be computed.
+//! All memory is allocated on construction.
+class PartitionedConvolver {
+public:
+    //! `partitionSize` must be a power of two.
+    PartitionedConvolver(std::span<const float> impulseResponse, std::size_t partitionSize);
+
+    [[nodiscard]] std::size_t partitionSize() const { return _partitionSize; }
+    [[nodiscard]] std::size_t numPartitions() const { return _numPartitions; }
+
+    //! Reads `partitionSize()` input samples and writes the `partitionSize()` output samples of the same span of time.
+    //! `in` and `out` may alias.
+    void process(const float* in, float* out);
+
+    void reset();
+
+private:
+    //! The spectrum of partition `index`, in the frequency-domain delay line or the impulse response.
+    [[nodiscard]] std::size_t spectrumOffset(std::size_t index) const { return index * _binStride; }
+
+    std::size_t _partitionSize;
+    std::size_t _numPartitions;
+    std::size_t _binStride; //< `numBins`, rounded up to a whole number of SIMD lanes.
+
+    RealFFT _fft;
+
+    // The impulse response partitions, in the frequency domain. Includes the 1 / FFT size normalization.
+    common::AlignedBuffer<float> _impulseResponseRe;
+    common::AlignedBuffer<float> _impulseResponseIm;
+
+    // The spectra of the most recent `_numPartitions` input windows, newest at `_newestInput`.
+    common::AlignedBuffer<float> _inputRe;
+    common::AlignedBuffer<float> _inputIm;
+    std::size_t _newestInput{0};
+
+    common::AlignedBuffer<float> _inputWindow; //< The previous and current input partition.
+    common::AlignedBuffer<float> _accumulatorRe;
+    common::AlignedBuffer<float> _accumulatorIm;
+    common::AlignedBuffer<float> _output; //< 2 * partitionSize; only the second half is valid (overlap-save).
+};
+
+}
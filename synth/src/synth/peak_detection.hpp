@@ -0,0 +1,112 @@
+#pragma once
+
+#include <common/aligned_buffer.hpp>
+#include <common/simd.hpp>
+#include <synth/math.hpp>
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace synth {
+
+//! Estimates the true (inter-sample) peak of a signal: the peak of the analog waveform a DAC reconstructs, which can
+//! exceed every sample value. Each interval between two samples is upsampled 4x with a windowed-sinc interpolator,
+//! after ITU-R BS.1770. The four phases are the four lanes of a Float4, so each sample costs eight multiply-adds.
+//! The estimate for a sample is available `Delay` samples after it was pushed.
+class TruePeakDetector {
+public:
+    static constexpr std::size_t NumTaps = 8;
+    static constexpr std::size_t Delay = NumTaps / 2;
+
+    TruePeakDetector() {
+        // Phase p estimates the signal at (n + p/4), from samples n-3 ... n+4.
+        auto coefficients = std::array<std::array<float, common::simd::Width>, NumTaps>{};
+        for (auto phase = std::size_t{0}; phase < common::simd::Width; ++phase) {
+            const auto offset = static_cast<double>(phase) / common::simd::Width;
+            auto sum = 0.0;
+            auto values = std::array<double, NumTaps>{};
+            for (auto tap = std::size_t{0}; tap < NumTaps; ++tap) {
+                const auto t = offset - (static_cast<double>(tap) - static_cast<double>(Delay - 1));
+                values[tap] = sinc(t) * hann(t, static_cast<double>(Delay) + 0.5);
+                sum += values[tap];
+            }
+            // Normalize for unity gain at DC.
+            for (auto tap = std::size_t{0}; tap < NumTaps; ++tap) {
+                coefficients[tap][phase] = static_cast<float>(values[tap] / sum);
+            }
+        }
+        for (auto tap = std::size_t{0}; tap < NumTaps; ++tap) {
+            _coefficients[tap] = common::simd::Float4::load(coefficients[tap].data());
+        }
+    }
+
+    //! Pushes the newest sample, and returns the true peak around the sample pushed `Delay` samples ago.
+    [[nodiscard]] float push(float in) {
+        using common::simd::Float4;
+
+        // Stored twice, so the most recent NumTaps samples are always contiguous.
+        _history[_index] = in;
+        _history[_index + NumTaps] = in;
+        _index = (_index + 1) % NumTaps;
+
+        auto phases = Float4::zero();
+        for (auto tap = std::size_t{0}; tap < NumTaps; ++tap) {
+            phases = phases + _coefficients[tap] * Float4::broadcast(_history[_index + tap]);
+        }
+        return abs(phases).horizontalMax();
+    }
+
+private:
+    [[nodiscard]] static double sinc(double t) {
+        return t == 0 ? 1.0 : std::sin(M_PI * t) / (M_PI * t);
+    }
+
+    [[nodiscard]] static double hann(double t, double halfWidth) {
+        return std::abs(t) >= halfWidth ? 0.0 : 0.5 * (1 + std::cos(M_PI * t / halfWidth));
+    }
+
+    std::array<common::simd::Float4, NumTaps> _coefficients;
+    std::array<float, 2 * NumTaps> _history{};
+    std::size_t _index{0};
+};
+
+//! The maximum of the last `windowLength` values pushed, in amortized constant time (a monotonic queue).
+//! Memory is allocated on construction.
+class SlidingMaximum {
+public:
+    explicit SlidingMaximum(std::size_t windowLength) :
+        _windowLength{windowLength},
+        _values(std::bit_ceil(windowLength + 1)),
+        _indices(_values.size()),
+        _mask{_values.size() - 1} {}
+
+    [[nodiscard]] float push(float value) {
+        // Older values that are no larger can never be the maximum again.
+        while (_back != _front && _values[(_back - 1) & _mask] <= value) {
+            --_back;
+        }
+        _values[_back & _mask] = value;
+        _indices[_back & _mask] = _count;
+        ++_back;
+
+        if (_indices[_front & _mask] + _windowLength <= _count) {
+            ++_front;
+        }
+        ++_count;
+        return _values[_front & _mask];
+    }
+
+private:
+    std::size_t _windowLength;
+    common::AlignedBuffer<float> _values;
+    common::AlignedBuffer<std::uint64_t> _indices;
+    std::size_t _mask;
+
+    std::uint64_t _front{0};
+    std::uint64_t _back{0};
+    std::uint64_t _count{0};
+};
+
+}
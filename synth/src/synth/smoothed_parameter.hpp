@@ -0,0 +1,128 @@
+#pragma once
+
+#include <common/ring_buffer.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+
+namespace synth {
+
+//! A parameter that glides to new values instead of jumping, so changes from the UI don't click.
+//! The audio thread advances it once per block, and gets back either one constant (the fast path: a parameter that
+//! isn't changing costs a branch per block) or a linear ramp with one value per sample, precomputed into a buffer.
+//! Not thread safe; this belongs to whichever thread processes audio. Other threads pass new targets through the
+//! owner's parameters, as usual.
+class SmoothedParameter {
+public:
+    //! Long enough to hide the step, short enough that the control still feels immediate.
+    static constexpr double DefaultRamp_ms = 20.0;
+
+    //! The parameter's values over one block.
+    class Block {
+    public:
+        Block(float value, const float* ramp) :
+            _value{value},
+            _ramp{ramp} {}
+
+        [[nodiscard]] bool isConstant() const { return _ramp == nullptr; }
+
+        //! The constant, or the value at the end of the block.
+        [[nodiscard]] float value() const { return _value; }
+
+        [[nodiscard]] float operator[](std::size_t i) const { return _ramp ? _ramp[i] : _value; }
+
+    private:
+        float _value;
+        const float* _ramp;
+    };
+
+    SmoothedParameter(float value, double sampleRate, double ramp_ms = DefaultRamp_ms) :
+        _start{value},
+        _current{value},
+        _target{value},
+        _rampLength{std::max<std::size_t>(1, static_cast<std::size_t>(ramp_ms * sampleRate / 1000))} {}
+
+    //! Starts a ramp from the current value to `target`. Setting the same target again does nothing, so this is cheap
+    //! to call every block.
+    void setTarget(float target) {
+        if (target == _target) {
+            return;
+        }
+        _target = target;
+        _start = _current;
+        _position = 0;
+    }
+
+    //! Jumps to `value`, abandoning any ramp.
+    void reset(float value) {
+        _start = _current = _target = value;
+        _position = _rampLength;
+    }
+
+    [[nodiscard]] float target() const { return _target; }
+    [[nodiscard]] bool isSmoothing() const { return _position < _rampLength; }
+
+    //! Advances by `numSamples` (at most one audio block), and returns the values for those samples.
+    //! The returned block refers to this parameter's buffer, so it is only valid until the next call.
+    [[nodiscard]] Block nextBlock(std::size_t numSamples = common::audio::AudioBlockSize) {
+        if (!isSmoothing()) {
+            return Block{_current, nullptr};
+        }
+
+        numSamples = std::min(numSamples, _ramp.size());
+        const auto numRamped = std::min(numSamples, _rampLength - _position);
+        // Computed from the start of the ramp rather than accumulated, so rounding errors don't build up.
+        const auto step = (_target - _start) / static_cast<float>(_rampLength);
+        for (auto i = std::size_t{0}; i < numRamped; ++i) {
+            _ramp[i] = _start + step * static_cast<float>(_position + i + 1);
+        }
+        std::fill(_ramp.begin() + numRamped, _ramp.begin() + numSamples, _target);
+
+        _position += numRamped;
+        _current = isSmoothing() ? _ramp[numSamples - 1] : _target;
+        return Block{_current, _ramp.data()};
+    }
+
+private:
+    float _start;
+    float _current;
+    float _target;
+    std::size_t _rampLength;
+    std::size_t _position{_rampLength};
+    common::audio::FrameBlock _ramp{};
+};
+
+//! samples[i] *= gain[i].
+inline void applyGain(std::span<float> samples, const SmoothedParameter::Block& gain) {
+    if (gain.isConstant()) {
+        const auto value = gain.value();
+        for (auto& sample : samples) {
+            sample *= value;
+        }
+    } else {
+        for (auto i = std::size_t{0}; i < samples.size(); ++i) {
+            samples[i] *= gain[i];
+        }
+    }
+}
+
+//! dry[i] = dryGain[i] * dry[i] + wetGain[i] * wet[i]: the output stage of every wet/dry effect.
+inline void mixWetDry(std::span<float> dry,
+                      std::span<const float> wet,
+                      const SmoothedParameter::Block& dryGain,
+                      const SmoothedParameter::Block& wetGain) {
+    if (dryGain.isConstant() && wetGain.isConstant()) {
+        const auto dryValue = dryGain.value();
+        const auto wetValue = wetGain.value();
+        for (auto i = std::size_t{0}; i < dry.size(); ++i) {
+            dry[i] = dryValue * dry[i] + wetValue * wet[i];
+        }
+    } else {
+        for (auto i = std::size_t{0}; i < dry.size(); ++i) {
+            dry[i] = dryGain[i] * dry[i] + wetGain[i] * wet[i];
+        }
+    }
+}
+
+}
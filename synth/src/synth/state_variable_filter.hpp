@@ -0,0 +1,229 @@
+#pragma once
+
+#include "common/simd.hpp"
+#include "synth/math.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace synth {
+
+enum class FilterType {
+    LowPass = 0,
+    HighPass,
+    BandPass,
+    Notch
+};
+
+//! A topology-preserving transform (trapezoidal) state-variable filter, after Zavalishin and Simper.
+//! Unlike the forward Euler filters, the response is exact at the cutoff (it is prewarped), it is stable up to Nyquist,
+//! and the cutoff can be modulated every sample without blowing up.
+//! Every output type comes from the same two integrators; the type only changes the mix `m0 * in + m1 * band + m2 * low`.
+namespace svf {
+
+//! Resonance is in [0, 1): 0 is a gentle, non-resonant response (Q = 0.5), values near 1 ring for a long time.
+constexpr float MaxResonance = 0.98f;
+
+//! Q = 1/sqrt(2): the flattest passband. Used for the stages of a cascade that aren't the resonant one.
+constexpr float ButterworthDamping = static_cast<float>(M_SQRT2);
+
+struct Coefficients {
+    float a1;
+    float a2;
+    float a3;
+
+    float m0; //< Input mix.
+    float m1; //< Band-pass mix.
+    float m2; //< Low-pass mix.
+};
+
+[[nodiscard]] inline float toDamping(float resonance) {
+    return 2.f * (1.f - std::clamp(resonance, 0.f, MaxResonance));
+}
+
+//! `damping` is k = 1/Q.
+[[nodiscard]] inline Coefficients computeCoefficients(FilterType type, double sampleRate, float cutoffFrequencyHz, float damping) {
+    // Keep the prewarp away from its pole at Nyquist.
+    const auto cutoff = std::clamp(static_cast<double>(cutoffFrequencyHz), 1.0, 0.49 * sampleRate);
+    const auto g = static_cast<float>(std::tan(M_PI * cutoff / sampleRate));
+    const auto k = damping;
+
+    auto result = Coefficients{};
+    result.a1 = 1.f / (1.f + g * (g + k));
+    result.a2 = g * result.a1;
+    result.a3 = g * result.a2;
+
+    switch (type) {
+    case FilterType::LowPass:
+        result.m0 = 0.f, result.m1 = 0.f, result.m2 = 1.f;
+        break;
+    case FilterType::HighPass:
+        result.m0 = 1.f, result.m1 = -k, result.m2 = -1.f;
+        break;
+    case FilterType::BandPass:
+        result.m0 = 0.f, result.m1 = 1.f, result.m2 = 0.f;
+        break;
+    case FilterType::Notch:
+        result.m0 = 1.f, result.m1 = -k, result.m2 = 0.f;
+        break;
+    }
+    return result;
+}
+
+}
+
+//! Four independent state-variable filters, one per SIMD lane, each with its own coefficients.
+//! Lanes can be channels, voices, or (see CascadedStateVariableFilter) the stages of one series filter.
+class StateVariableFilter4 {
+public:
+    using Float4 = common::simd::Float4;
+
+    struct Coefficients {
+        Float4 a1;
+        Float4 a2;
+        Float4 a3;
+        Float4 m0;
+        Float4 m1;
+        Float4 m2;
+
+        [[nodiscard]] static Coefficients fromLanes(const std::array<svf::Coefficients, common::simd::Width>& lanes) {
+            auto gather = [&lanes](float svf::Coefficients::*member) {
+                return Float4::fromLanes(lanes[0].*member, lanes[1].*member, lanes[2].*member, lanes[3].*member);
+            };
+            return {gather(&svf::Coefficients::a1),
+                    gather(&svf::Coefficients::a2),
+                    gather(&svf::Coefficients::a3),
+                    gather(&svf::Coefficients::m0),
+                    gather(&svf::Coefficients::m1),
+                    gather(&svf::Coefficients::m2)};
+        }
+
+        [[nodiscard]] static Coefficients zero() {
+            return {Float4::zero(), Float4::zero(), Float4::zero(), Float4::zero(), Float4::zero(), Float4::zero()};
+        }
+    };
+
+    StateVariableFilter4() = default;
+    explicit StateVariableFilter4(const Coefficients& coefficients) : _coefficients{coefficients} {}
+
+    void setCoefficients(const Coefficients& coefficients) {
+        _coefficients = coefficients;
+        _step = Coefficients::zero();
+    }
+
+    //! Moves the coefficients linearly to `target` over the next `numSamples` calls to `nextSampleRamped`.
+    //! Interpolating the TPT coefficients (rather than the cutoff) keeps the filter stable throughout the ramp.
+    void rampCoefficients(const Coefficients& target, std::size_t numSamples) {
+        const auto scale = Float4::broadcast(1.f / static_cast<float>(std::max<std::size_t>(numSamples, 1)));
+        _step.a1 = (target.a1 - _coefficients.a1) * scale;
+        _step.a2 = (target.a2 - _coefficients.a2) * scale;
+        _step.a3 = (target.a3 - _coefficients.a3) * scale;
+        _step.m0 = (target.m0 - _coefficients.m0) * scale;
+        _step.m1 = (target.m1 - _coefficients.m1) * scale;
+        _step.m2 = (target.m2 - _coefficients.m2) * scale;
+    }
+
+    [[nodiscard]] Float4 nextSample(Float4 in) {
+        const auto& c = _coefficients;
+        const auto v3 = in - _ic2eq;
+        const auto v1 = c.a1 * _ic1eq + c.a2 * v3;
+        const auto v2 = _ic2eq + c.a2 * _ic1eq + c.a3 * v3;
+        _ic1eq = v1 + v1 - _ic1eq;
+        _ic2eq = v2 + v2 - _ic2eq;
+        return c.m0 * in + c.m1 * v1 + c.m2 * v2;
+    }
+
+    [[nodiscard]] Float4 nextSampleRamped(Float4 in) {
+        _coefficients.a1 = _coefficients.a1 + _step.a1;
+        _coefficients.a2 = _coefficients.a2 + _step.a2;
+        _coefficients.a3 = _coefficients.a3 + _step.a3;
+        _coefficients.m0 = _coefficients.m0 + _step.m0;
+        _coefficients.m1 = _coefficients.m1 + _step.m1;
+        _coefficients.m2 = _coefficients.m2 + _step.m2;
+        return nextSample(in);
+    }
+
+    void reset() {
+        _ic1eq = Float4::zero();
+        _ic2eq = Float4::zero();
+    }
+
+private:
+    Coefficients _coefficients{Coefficients::zero()};
+    Coefficients _step{Coefficients::zero()};
+
+    // The integrator states.
+    Float4 _ic1eq{Float4::zero()};
+    Float4 _ic2eq{Float4::zero()};
+};
+
+//! One to four state-variable filters in series, computed together in the lanes of a StateVariableFilter4.
+//! Each stage runs one sample behind the stage before it, so all stages advance in a single vector step; the cost is
+//! `numStages - 1` samples of latency. Only the last stage is resonant, so the slope steepens by 12 dB/oct per stage
+//! without the resonant peaks stacking.
+//! This is the DSP only; it isn't thread safe and belongs to whichever thread processes audio.
+class CascadedStateVariableFilter {
+public:
+    static constexpr std::size_t MaxStages = common::simd::Width;
+
+    CascadedStateVariableFilter(double sampleRate, FilterType type, float cutoffFrequencyHz, float resonance, std::size_t numStages) :
+        _sampleRate{sampleRate},
+        _type{type},
+        _resonance{resonance},
+        _numStages{std::clamp<std::size_t>(numStages, 1, MaxStages)},
+        _filter{computeCoefficients(cutoffFrequencyHz)} {}
+
+    //! Type and resonance changes take effect at the next call to `setCutoffFrequencyHz` or `rampCutoffFrequencyHz`.
+    void setType(FilterType type) { _type = type; }
+    void setResonance(float resonance) { _resonance = resonance; }
+
+    void setCutoffFrequencyHz(float frequencyHz) {
+        _filter.setCoefficients(computeCoefficients(frequencyHz));
+    }
+
+    //! Moves the filter to `frequencyHz` over the next `numSamples` calls to `nextSampleRamped`.
+    void rampCutoffFrequencyHz(float frequencyHz, std::size_t numSamples) {
+        _filter.rampCoefficients(computeCoefficients(frequencyHz), numSamples);
+    }
+
+    [[nodiscard]] float nextSample(float in) {
+        _stageOutputs = _filter.nextSample(shiftIn(in, _stageOutputs));
+        return lastStageOutput();
+    }
+
+    [[nodiscard]] float nextSampleRamped(float in) {
+        _stageOutputs = _filter.nextSampleRamped(shiftIn(in, _stageOutputs));
+        return lastStageOutput();
+    }
+
+    [[nodiscard]] std::size_t numStages() const { return _numStages; }
+    [[nodiscard]] std::size_t latencySamples() const { return _numStages - 1; }
+
+private:
+    [[nodiscard]] StateVariableFilter4::Coefficients computeCoefficients(float cutoffFrequencyHz) const {
+        const auto inner = svf::computeCoefficients(_type, _sampleRate, cutoffFrequencyHz, svf::ButterworthDamping);
+        const auto last = svf::computeCoefficients(_type, _sampleRate, cutoffFrequencyHz, svf::toDamping(_resonance));
+
+        // Lanes past the last stage compute a harmless copy of it; their output is never read.
+        auto lanes = std::array<svf::Coefficients, MaxStages>{};
+        for (auto i = std::size_t{0}; i < MaxStages; ++i) {
+            lanes[i] = i + 1 < _numStages ? inner : last;
+        }
+        return StateVariableFilter4::Coefficients::fromLanes(lanes);
+    }
+
+    [[nodiscard]] float lastStageOutput() const {
+        return _numStages == 1 ? _stageOutputs.first() : _stageOutputs.lanes()[_numStages - 1];
+    }
+
+    double _sampleRate;
+    FilterType _type;
+    float _resonance;
+    std::size_t _numStages;
+
+    StateVariableFilter4 _filter;
+    common::simd::Float4 _stageOutputs{common::simd::Float4::zero()};
+};
+
+}
@@ -5,8 +5,10 @@
 #include <synth/filter.hpp>
 #include <synth/low_frequency_oscillator.hpp>
 #include <synth/oscillator.hpp>
+#include <synth/smoothed_parameter.hpp>
 #include <synth/voice.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -17,10 +19,9 @@ namespace {
 //! These things are modifiable while the synth is active.
 struct SynthesizerState {
     TripleWaveTableT waveTables;
-    float gain;
+    SmoothedParameter gain;
     std::vector<Voice> voices;
     common::midi::Keyboard keyboard;
-    std::optional<common::audio::FrameBlock> lastBlock;
 };
 
 [[nodiscard]] double noteToFrequencyHertz(int note) {
@@ -59,12 +60,29 @@ void triggerVoiceIfNecessary(Voice& voice, const common::midi::Note& previousNot
     return result;
 }
 
+//! Applies one midi event to the keyboard, and triggers the voices it changes.
+void applyMidiEvent(SynthesizerState& state, const common::midi::Event& event) {
+    if (event.type == common::midi::EventType::SustainOff) {
+        // Lifting the pedal can release any number of notes.
+        const auto previousNotes = state.keyboard.audibleNotes;
+        state.keyboard.apply(event);
+        for (auto i = std::size_t{0}; i < previousNotes.size(); ++i) {
+            triggerVoiceIfNecessary(state.voices[i], previousNotes[i], state.keyboard.audibleNotes[i]);
+        }
+    } else if (event.note < common::midi::NumMidiNodes) {
+        // Everything else changes one note at most.
+        const auto previousNote = state.keyboard.audibleNotes[event.note];
+        state.keyboard.apply(event);
+        triggerVoiceIfNecessary(state.voices[event.note], previousNote, state.keyboard.audibleNotes[event.note]);
+    }
+}
+
 }
 
 class Synthesizer::impl {
 public:
     impl(double sampleRate, const TripleWaveTableT& waveTables, float gain, const ADSR& adsr, float lfoFrequency, float lfoGain) :
-        _state{{SynthesizerState{waveTables, gain, buildVoices(sampleRate, adsr, lfoFrequency, lfoGain)}}},
+        _state{{SynthesizerState{waveTables, SmoothedParameter{gain, sampleRate}, buildVoices(sampleRate, adsr, lfoFrequency, lfoGain)}}},
         _sampleRate(sampleRate) {}
 
     ~impl() = default;
@@ -109,41 +127,34 @@ public:
 
     void setGain(float gain) {
         _state.write([&](SynthesizerState& state) {
-            state.gain = gain;
+            state.gain.setTarget(gain);
         });
     }
 
-    void respondToKeyboardChanges(const common::midi::Keyboard& latestKeyboard) {
-        const auto currentKeyboard = _state.read().keyboard;
-        if (latestKeyboard != currentKeyboard) {
-            _state.write([&latestKeyboard](SynthesizerState& state) {
-                for (auto i = 0; i < latestKeyboard.audibleNotes.size(); ++i) {
-                    auto& previousNote = state.keyboard.audibleNotes[i];
-                    const auto& currentNote = latestKeyboard.audibleNotes[i];
-
-                    auto& voice = state.voices[i];
-                    triggerVoiceIfNecessary(voice, previousNote, currentNote);
-                    previousNote = currentNote;
-                }
-            });
-        }
+    void respondToMidiEvent(const common::midi::Event& event) {
+        _state.write([&event](SynthesizerState& state) {
+            applyMidiEvent(state, event);
+        });
     }
 
-    [[nodiscard]] common::audio::FrameBlock getNextBlock() {
+    [[nodiscard]] common::audio::FrameBlock getNextBlock(std::span<const ScheduledEvent> events) {
         auto result = common::audio::FrameBlock{};
-        _state.write([&result](SynthesizerState& state) {
-            for (auto i = 0; i < result.size(); ++i) {
-                result[i] = nextSample(state) * state.gain;
+        _state.write([&result, events](SynthesizerState& state) {
+            auto i = std::size_t{0};
+            for (const auto& scheduled : events) {
+                for (const auto end = std::min(scheduled.offset, result.size()); i < end; ++i) {
+                    result[i] = nextSample(state);
+                }
+                applyMidiEvent(state, scheduled.event);
+            }
+            for (; i < result.size(); ++i) {
+                result[i] = nextSample(state);
             }
-            state.lastBlock = result;
+            applyGain(result, state.gain.nextBlock(result.size()));
         });
         return result;
     }
 
-    [[nodiscard]] const std::optional<common::audio::FrameBlock>& getLastBlock() const {
-        return _state.readConst().lastBlock;
-    }
-
     [[nodiscard]] double sampleRate() const {
         return _sampleRate;
     }
@@ -194,16 +205,16 @@ void Synthesizer::setLfoGain(float gain) {
     _impl->setLfoGain(gain);
 }
 
-void Synthesizer::respondToKeyboardChanges(const common::midi::Keyboard& keyboard) {
-    _impl->respondToKeyboardChanges(keyboard);
+void Synthesizer::respondToMidiEvent(const common::midi::Event& event) {
+    _impl->respondToMidiEvent(event);
 }
 
 common::audio::FrameBlock Synthesizer::getNextBlock() {
-    return _impl->getNextBlock();
+    return _impl->getNextBlock({});
 }
 
-const std::optional<common::audio::FrameBlock>& Synthesizer::getLastBlock() const {
-    return _impl->getLastBlock();
+common::audio::FrameBlock Synthesizer::getNextBlockWithEvents(std::span<const ScheduledEvent> events) {
+    return _impl->getNextBlock(events);
 }
 
 double Synthesizer::sampleRate() const {
@@ -10,7 +10,6 @@
 
 #include <functional>
 #include <memory>
-#include <optional>
 
 namespace synth {
 
@@ -34,14 +33,14 @@ public:
     void setLfoFrequency(float frequencyHz);
     void setLfoGain(float gain);
 
-    //! Respond to changes in the keyboard (trigger voices on or off).
-    void respondToKeyboardChanges(const common::midi::Keyboard& keyboard) override;
+    //! Respond to one midi event (trigger voices on or off).
+    void respondToMidiEvent(const common::midi::Event& event) override;
 
     //! Increments counters in envelopes and everything. It's probably not a good idea to throw away the result!
     [[nodiscard]] common::audio::FrameBlock getNextBlock() override;
 
-    //! The last block returned by `getNextBlock`, for bookkeeping.
-    [[nodiscard]] const std::optional<common::audio::FrameBlock>&  getLastBlock() const;
+    //! Sample accurate: renders up to each event's offset, applies it, and carries on.
+    [[nodiscard]] common::audio::FrameBlock getNextBlockWithEvents(std::span<const ScheduledEvent> events) override;
 
     [[nodiscard]] double sampleRate() const override;
 
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "common/wav_file.hpp"
+#include "synth/audio_pipeline.hpp"
+
+#include <filesystem>
+
+namespace synth {
+
+//! Writes every block to a 32 bit float WAV file. It's never full, so a pipeline that ends in one runs as fast as the
+//! CPU allows rather than at the pace of an audio device.
+class WavFileSink : public I_SinkNode {
+public:
+    WavFileSink(const std::filesystem::path& path, double sampleRate) :
+        _writer{path, sampleRate} {}
+
+    [[nodiscard]] bool isFull() const override { return false; }
+
+    bool push(const common::audio::FrameBlock& block) override {
+        _writer.write(block);
+        return true;
+    }
+
+    //! Completes the file. Otherwise, that happens when the sink is destroyed.
+    void close() {
+        _writer.close();
+    }
+
+    [[nodiscard]] double duration_s() const {
+        return _writer.duration_s();
+    }
+
+private:
+    common::audio::WavFileWriter _writer;
+};
+
+}